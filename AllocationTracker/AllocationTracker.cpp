@@ -0,0 +1,186 @@
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#ifdef FLI_TRACK_ALLOCATIONS
+
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+struct Record {
+    const char*   site;
+    std::size_t   bytes;
+    std::uint64_t evaluation;
+};
+
+/**
+ * @brief - Literals may be freed by another thread than the one
+ *          which created them, so the records are shared.
+ *          Intentionally never destroyed, literals may be freed after main().
+ */
+struct State {
+    std::mutex mutex;
+    std::unordered_map<const void*, Record> live;
+    std::size_t live_bytes = 0;
+    std::uint64_t next_evaluation = 1;
+};
+
+State& state()
+{
+    static State* instance = new State();
+    return *instance;
+}
+
+thread_local const char* current_site = "other";
+thread_local AllocationTracker::Evaluation* current_evaluation = nullptr;
+
+std::vector<AllocationTracker::SiteReport> group(const std::map<std::string, AllocationTracker::SiteReport>& sites)
+{
+    std::vector<AllocationTracker::SiteReport> result;
+    for (const auto&[name, report] : sites)
+        result.push_back(report);
+
+    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.bytes > b.bytes; });
+    return result;
+}
+
+}
+
+AllocationTracker::Site::Site(const char* site)
+        : previous(current_site)
+{
+    current_site = site;
+}
+
+AllocationTracker::Site::~Site()
+{
+    current_site = previous;
+}
+
+AllocationTracker::Evaluation::Evaluation()
+        : previous(current_evaluation)
+{
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+
+    id = s.next_evaluation++;
+    initial_bytes = peak_bytes = s.live_bytes;
+    current_evaluation = this;
+}
+
+AllocationTracker::Evaluation::~Evaluation()
+{
+    if (finished)
+        return;
+
+    EvaluationReport report = finish();
+    if (!report.leaks.empty()) {
+        std::cerr << "! Literals leaked by an evaluation:\n";
+        write_report(std::cerr, report.leaks);
+    }
+}
+
+AllocationTracker::EvaluationReport AllocationTracker::Evaluation::finish()
+{
+    EvaluationReport report;
+    if (finished)
+        return report;
+
+    finished = true;
+
+    /// A suspended evaluation may finish after a later one started on the same thread.
+    if (current_evaluation == this) {
+        current_evaluation = previous;
+    } else {
+        for (Evaluation* e = current_evaluation; e; e = e->previous) {
+            if (e->previous == this) {
+                e->previous = previous;
+                break;
+            }
+        }
+    }
+
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+
+    report.peak_live_bytes = peak_bytes - initial_bytes;
+
+    std::map<std::string, SiteReport> leaks;
+    for (const auto&[literal, record] : s.live) {
+        if (record.evaluation != id)
+            continue;
+
+        SiteReport& site = leaks[record.site];
+        site.site = record.site;
+        ++site.objects;
+        site.bytes += record.bytes;
+    }
+
+    report.leaks = group(leaks);
+    return report;
+}
+
+void AllocationTracker::on_allocate(const void* literal)
+{
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+    s.live[literal] = Record{current_site, 0, current_evaluation ? current_evaluation->id : 0};
+}
+
+void AllocationTracker::on_bytes(const void* literal, std::size_t bytes)
+{
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+
+    auto it = s.live.find(literal);
+    if (it == s.live.end())
+        return;
+
+    it->second.bytes += bytes;
+    s.live_bytes += bytes;
+
+    for (Evaluation* e = current_evaluation; e; e = e->previous)
+        e->peak_bytes = std::max(e->peak_bytes, s.live_bytes);
+}
+
+void AllocationTracker::on_free(const void* literal)
+{
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+
+    auto it = s.live.find(literal);
+    if (it == s.live.end())
+        return;
+
+    s.live_bytes -= it->second.bytes;
+    s.live.erase(it);
+}
+
+std::vector<AllocationTracker::SiteReport> AllocationTracker::live_by_site()
+{
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+
+    std::map<std::string, SiteReport> sites;
+    for (const auto&[literal, record] : s.live) {
+        SiteReport& site = sites[record.site];
+        site.site = record.site;
+        ++site.objects;
+        site.bytes += record.bytes;
+    }
+
+    return group(sites);
+}
+
+#endif
+
+void AllocationTracker::write_report(std::ostream& os, const std::vector<SiteReport>& sites)
+{
+    for (const SiteReport& site : sites)
+        os << "    " << std::left << std::setw(12) << site.site << std::right
+           << ' ' << site.objects << " literals, " << site.bytes << " bytes\n";
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief - Debug accounting of the live literals, compiled in with the
+ *          FLI_TRACK_ALLOCATIONS CMake option and free otherwise.
+ *
+ *          Every literal is recorded with the allocation site active on its
+ *          thread when it was created, see Site, and the evaluation it was
+ *          created in, see Evaluation. Literals created by an evaluation and
+ *          still alive when it ends are reported as leaks.
+ */
+class AllocationTracker {
+public:
+    struct SiteReport {
+        std::string site;
+        std::size_t objects = 0;
+        std::size_t bytes = 0;
+    };
+
+    struct EvaluationReport {
+        /// The most bytes of literals alive at once during the evaluation,
+        /// over the ones alive when it started.
+        std::size_t peak_live_bytes = 0;
+
+        /// The literals created by the evaluation and still alive, by site.
+        std::vector<SiteReport> leaks;
+    };
+
+#ifdef FLI_TRACK_ALLOCATIONS
+    static constexpr bool enabled = true;
+
+    /**
+     * @brief - Labels the literals created on this thread while it lives.
+     *
+     * @param site - Must live as long as the program, like a string literal.
+     */
+    class Site {
+        const char* previous;
+
+    public:
+        explicit Site(const char* site);
+        ~Site();
+
+        Site(const Site&) = delete;
+        Site& operator=(const Site&) = delete;
+    };
+
+    /**
+     * @brief - A top-level evaluation on this thread, from its construction to finish().
+     *          A destroyed unfinished evaluation reports its leaks to std::cerr.
+     */
+    class Evaluation {
+        Evaluation*   previous;
+        std::uint64_t id;
+        std::size_t   initial_bytes;
+        std::size_t   peak_bytes;
+        bool          finished = false;
+
+        friend class AllocationTracker;
+
+    public:
+        Evaluation();
+        ~Evaluation();
+
+        Evaluation(const Evaluation&) = delete;
+        Evaluation& operator=(const Evaluation&) = delete;
+
+        EvaluationReport finish();
+    };
+
+    static void on_allocate(const void* literal);
+    static void on_bytes(const void* literal, std::size_t bytes);
+    static void on_free(const void* literal);
+
+    /**
+     * @returns - The live literals by site.
+     */
+    static std::vector<SiteReport> live_by_site();
+#else
+    static constexpr bool enabled = false;
+
+    class Site {
+    public:
+        explicit Site(const char*) {}
+    };
+
+    class Evaluation {
+    public:
+        EvaluationReport finish() { return {}; }
+    };
+
+    static void on_allocate(const void*) {}
+    static void on_bytes(const void*, std::size_t) {}
+    static void on_free(const void*) {}
+
+    static std::vector<SiteReport> live_by_site() { return {}; }
+#endif
+
+    static void write_report(std::ostream& os, const std::vector<SiteReport>& sites);
+};
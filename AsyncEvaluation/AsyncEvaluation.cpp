@@ -0,0 +1,110 @@
+#include "AsyncEvaluation.h"
+
+#include <thread>
+
+#include "Expression.h"
+#include "evaluation_cancelled_exception.h"
+
+AsyncEvaluation::State::State(const std::string& input)
+        : input(input)
+{}
+
+AsyncEvaluation::AsyncEvaluation(std::shared_ptr<State> state)
+        : state(std::move(state))
+{}
+
+AsyncEvaluation AsyncEvaluation::start(const std::string& expression,
+                                       SymbolTable& symbol_table,
+                                       ThreadPool* pool,
+                                       const EvaluationBudget& budget,
+                                       const std::string& input)
+{
+    auto state = std::make_shared<State>(input);
+    state->context.set_budget(budget);
+
+    auto task = [state, expression, &symbol_table] {
+        evaluate(state, expression, symbol_table);
+    };
+
+    if (pool)
+        pool->submit(task);
+    else
+        std::thread(task).detach();
+
+    return AsyncEvaluation(state);
+}
+
+void AsyncEvaluation::evaluate(const std::shared_ptr<State>& state,
+                               const std::string& expression,
+                               SymbolTable& symbol_table)
+{
+    std::unique_ptr<Literal> result;
+    std::exception_ptr error;
+    STATUS status = STATUS::FINISHED;
+
+    try {
+        state->context.check_cancelled();
+        state->context.begin_evaluation();
+        Metrics::EvaluationTimer timer;
+        result.reset(Expression(expression, symbol_table, nullptr, state->context).calculate());
+        timer.succeed();
+    } catch (evaluation_cancelled_exception&) {
+        error = std::current_exception();
+        status = STATUS::CANCELLED;
+    } catch (...) {
+        error = std::current_exception();
+        status = STATUS::FAILED;
+    }
+    state->context.flush_output();
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->result = std::move(result);
+        state->error = error;
+        state->status = status;
+    }
+    state->done.notify_all();
+}
+
+AsyncEvaluation::STATUS AsyncEvaluation::poll() const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->status;
+}
+
+AsyncEvaluation::STATUS AsyncEvaluation::wait() const
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [this] { return state->status != STATUS::RUNNING; });
+    return state->status;
+}
+
+bool AsyncEvaluation::wait_for(std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    return state->done.wait_for(lock, timeout, [this] { return state->status != STATUS::RUNNING; });
+}
+
+void AsyncEvaluation::cancel()
+{
+    state->context.cancel();
+}
+
+std::unique_ptr<Literal> AsyncEvaluation::get()
+{
+    wait();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->error)
+        std::rethrow_exception(state->error);
+
+    return std::move(state->result);
+}
+
+std::string AsyncEvaluation::get_output() const
+{
+    wait();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->output.str();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "Literal.h"
+#include "SymbolTable.h"
+#include "EvaluationContext.h"
+#include "ThreadPool.h"
+
+/**
+ * @brief - Handle of an expression evaluated on another thread.
+ *
+ *          The handle can be polled, awaited and cancelled from any thread.
+ *          A cancelled evaluation stops at its next function call, so the
+ *          thread evaluating it is released shortly after cancel().
+ */
+class AsyncEvaluation {
+public:
+    enum class STATUS {
+        RUNNING,
+        FINISHED,
+        FAILED,
+        CANCELLED
+    };
+
+private:
+    struct State {
+        std::istringstream input;
+        std::ostringstream output{};
+        EvaluationContext  context{input, output};
+
+        std::mutex              mutex{};
+        std::condition_variable done{};
+        STATUS                  status = STATUS::RUNNING;
+
+        std::unique_ptr<Literal> result{};
+        std::exception_ptr       error{};
+
+        explicit State(const std::string& input);
+    };
+
+    std::shared_ptr<State> state;
+
+private:
+    explicit AsyncEvaluation(std::shared_ptr<State> state);
+
+    static void evaluate(const std::shared_ptr<State>& state, const std::string& expression, SymbolTable& symbol_table);
+
+public:
+    /**
+     * @brief - Starts evaluating @p expression.
+     *
+     * @param symbol_table - Must outlive the evaluation and must not be
+     *                       modified while the evaluation runs.
+     * @param pool - The pool the evaluation runs on,
+     *               when there is none a new thread is started.
+     * @param budget - The limits of the evaluation.
+     * @param input - The numbers read() takes.
+     */
+    static AsyncEvaluation start(const std::string& expression,
+                                 SymbolTable& symbol_table,
+                                 ThreadPool* pool = nullptr,
+                                 const EvaluationBudget& budget = {},
+                                 const std::string& input = "");
+
+    /**
+     * @returns - The status of the evaluation, without waiting.
+     */
+    STATUS poll() const;
+
+    /**
+     * @brief - Waits until the evaluation is no longer running.
+     */
+    STATUS wait() const;
+
+    /**
+     * @brief - Waits at most @p timeout for the evaluation.
+     *
+     * @returns - Whether the evaluation is no longer running.
+     */
+    bool wait_for(std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief - Asks the evaluation to stop. Does not wait for it.
+     */
+    void cancel();
+
+    /**
+     * @brief - Waits for the evaluation and takes its value.
+     *          Can be called only once.
+     *
+     * @throws - The exception the evaluation failed with,
+     *           evaluation_cancelled_exception if it was cancelled.
+     */
+    std::unique_ptr<Literal> get();
+
+    /**
+     * @brief - Waits for the evaluation.
+     *
+     * @returns - What the evaluation printed with write().
+     */
+    std::string get_output() const;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief - Counts the calls of the global operator new of the process.
+ *          Only available in the executables AllocationCounter.cpp is linked into.
+ */
+namespace allocation_counter {
+
+std::uint64_t allocations();
+std::uint64_t bytes();
+
+}
@@ -0,0 +1,206 @@
+#include "Baseline.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief - Reads the subset of JSON the baselines are written in.
+ */
+class JsonReader {
+    std::string text;
+    std::size_t i = 0;
+
+    [[noreturn]] void fail(const std::string& what) const
+    {
+        throw std::invalid_argument("Baseline :: Invalid JSON at offset " + std::to_string(i) + ": " + what);
+    }
+
+    void skip_whitespace()
+    {
+        while (i < text.size() && std::isspace((unsigned char) text[i]))
+            ++i;
+    }
+
+public:
+    explicit JsonReader(std::string text)
+            : text(std::move(text))
+    {}
+
+    bool consume(char c)
+    {
+        skip_whitespace();
+        if (i < text.size() && text[i] == c) {
+            ++i;
+            return true;
+        }
+
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!consume(c))
+            fail(std::string("expected '") + c + "'");
+    }
+
+    std::string string()
+    {
+        expect('"');
+
+        std::string result;
+        while (i < text.size() && text[i] != '"') {
+            if (text[i] == '\\' && i + 1 < text.size())
+                ++i;
+            result.push_back(text[i++]);
+        }
+
+        expect('"');
+        return result;
+    }
+
+    double number()
+    {
+        skip_whitespace();
+
+        const char* begin = text.c_str() + i;
+        char* end = nullptr;
+        double result = std::strtod(begin, &end);
+        if (end == begin)
+            fail("expected a number");
+
+        i += end - begin;
+        return result;
+    }
+
+    /**
+     * @brief - Reads an object, calling @p on_member after each key,
+     *          which must read the member's value.
+     */
+    template<typename F>
+    void object(F on_member)
+    {
+        expect('{');
+        if (consume('}'))
+            return;
+
+        do {
+            std::string key = string();
+            expect(':');
+            on_member(key);
+        } while (consume(','));
+
+        expect('}');
+    }
+
+    void skip_value()
+    {
+        skip_whitespace();
+        if (i >= text.size())
+            fail("unexpected end");
+
+        if (text[i] == '"') {
+            string();
+        } else if (text[i] == '{') {
+            object([this](const std::string&) { skip_value(); });
+        } else if (consume('[')) {
+            if (consume(']'))
+                return;
+            do {
+                skip_value();
+            } while (consume(','));
+            expect(']');
+        } else if (text.compare(i, 4, "true") == 0 || text.compare(i, 4, "null") == 0) {
+            i += 4;
+        } else if (text.compare(i, 5, "false") == 0) {
+            i += 5;
+        } else {
+            number();
+        }
+    }
+
+    void end()
+    {
+        skip_whitespace();
+        if (i != text.size())
+            fail("trailing characters");
+    }
+};
+
+}
+
+Baseline Baseline::read(const std::string& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs)
+        throw std::invalid_argument("Baseline :: Cannot open " + path);
+
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+
+    Baseline baseline;
+    JsonReader reader(buffer.str());
+
+    reader.object([&](const std::string& key) {
+        if (key == "build_type") {
+            baseline.build_type = reader.string();
+        } else if (key == "runs") {
+            baseline.runs = (std::size_t) reader.number();
+        } else if (key == "benchmarks") {
+            reader.object([&](const std::string& name) {
+                BaselineEntry& entry = baseline.benchmarks[name];
+
+                reader.object([&](const std::string& field) {
+                    if (field == "median_ns")
+                        entry.ns_per_op.median = reader.number();
+                    else if (field == "low_ns")
+                        entry.ns_per_op.low = reader.number();
+                    else if (field == "high_ns")
+                        entry.ns_per_op.high = reader.number();
+                    else if (field == "allocations_per_op")
+                        entry.allocations_per_op = reader.number();
+                    else
+                        reader.skip_value();
+                });
+            });
+        } else {
+            reader.skip_value();
+        }
+    });
+
+    reader.end();
+    return baseline;
+}
+
+void Baseline::write(const std::string& path) const
+{
+    std::ofstream ofs(path);
+
+    ofs << std::setprecision(10);
+    ofs << "{\n";
+    ofs << "  \"build_type\": \"" << build_type << "\",\n";
+    ofs << "  \"runs\": " << runs << ",\n";
+    ofs << "  \"benchmarks\": {";
+
+    bool first = true;
+    for (const auto&[name, entry] : benchmarks) {
+        ofs << (first ? "\n" : ",\n");
+        ofs << "    \"" << name << "\": {"
+            << "\"median_ns\": " << entry.ns_per_op.median << ", "
+            << "\"low_ns\": " << entry.ns_per_op.low << ", "
+            << "\"high_ns\": " << entry.ns_per_op.high << ", "
+            << "\"allocations_per_op\": " << entry.allocations_per_op
+            << "}";
+        first = false;
+    }
+
+    ofs << "\n  }\n";
+    ofs << "}\n";
+
+    if (!ofs)
+        throw std::invalid_argument("Baseline :: Cannot write " + path);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Statistics.h"
+
+/**
+ * @brief - The stored measurements of a benchmark.
+ */
+struct BaselineEntry {
+    Estimate ns_per_op;
+    double   allocations_per_op = 0;
+};
+
+/**
+ * @brief - Benchmark results the regression gate compares against,
+ *          stored as JSON:
+ *          { "build_type": ..., "runs": ..., "benchmarks": { "name":
+ *            { "median_ns": ..., "low_ns": ..., "high_ns": ..., "allocations_per_op": ... } } }
+ */
+struct Baseline {
+    std::string build_type;
+    std::size_t runs = 0;
+    std::map<std::string, BaselineEntry> benchmarks;
+
+    /**
+     * @throws std::invalid_argument - If the file cannot be read or is not a valid baseline.
+     */
+    static Baseline read(const std::string& path);
+
+    /**
+     * @throws std::invalid_argument - If the file cannot be written.
+     */
+    void write(const std::string& path) const;
+};
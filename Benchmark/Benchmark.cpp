@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include <sys/resource.h>
+
+#include "AllocationCounter.h"
+
+#ifndef FLI_BUILD_TYPE
+#define FLI_BUILD_TYPE ""
+#endif
+
+Benchmark::Benchmark(std::string name, Setup setup)
+        : name(std::move(name)),
+          setup(std::move(setup))
+{}
+
+const std::string& Benchmark::get_name() const
+{
+    return name;
+}
+
+BenchmarkResult Benchmark::run(std::chrono::nanoseconds min_time) const
+{
+    Operation operation = setup();
+    operation();
+
+    std::uint64_t iterations = 1;
+
+    while (true) {
+        std::uint64_t allocations = allocation_counter::allocations();
+        std::uint64_t bytes = allocation_counter::bytes();
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::uint64_t i = 0; i < iterations; ++i)
+            operation();
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (elapsed >= min_time || iterations >= MAX_ITERATIONS) {
+            BenchmarkResult result;
+            result.name = name;
+            result.iterations = iterations;
+            result.ns_per_op = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (double) iterations;
+            result.allocations_per_op = (double) (allocation_counter::allocations() - allocations) / (double) iterations;
+            result.bytes_per_op = (double) (allocation_counter::bytes() - bytes) / (double) iterations;
+            result.peak_rss_kb = peak_rss_kb();
+            return result;
+        }
+
+        /// Aim a bit past min_time, growing at most 100 times at once.
+        double scale = elapsed.count() > 0 ? 1.4 * (double) min_time.count() / (double) elapsed.count() : 100;
+        iterations = std::min(MAX_ITERATIONS, (std::uint64_t) ((double) iterations * std::clamp(scale, 2.0, 100.0)));
+    }
+}
+
+long peak_rss_kb()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void write_json(std::ostream& os, const std::vector<BenchmarkResult>& results)
+{
+    os << std::setprecision(10);
+    os << "{\n";
+    os << "  \"context\": {\n";
+    os << "    \"build_type\": \"" << FLI_BUILD_TYPE << "\",\n";
+    os << "    \"peak_rss_kb\": " << peak_rss_kb() << "\n";
+    os << "  },\n";
+    os << "  \"benchmarks\": [";
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        os << (i ? ",\n" : "\n");
+        os << "    {"
+           << "\"name\": \"" << r.name << "\", "
+           << "\"iterations\": " << r.iterations << ", "
+           << "\"ns_per_op\": " << r.ns_per_op << ", "
+           << "\"allocations_per_op\": " << r.allocations_per_op << ", "
+           << "\"bytes_per_op\": " << r.bytes_per_op << ", "
+           << "\"peak_rss_kb\": " << r.peak_rss_kb
+           << "}";
+    }
+
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+void write_table(std::ostream& os, const std::vector<BenchmarkResult>& results)
+{
+    std::size_t width = 9;
+    for (const BenchmarkResult& r : results)
+        width = std::max(width, r.name.size());
+
+    os << std::left << std::setw((int) width) << "benchmark"
+       << std::right << std::setw(16) << "ns/op"
+       << std::setw(14) << "allocs/op"
+       << std::setw(14) << "bytes/op"
+       << std::setw(14) << "iterations"
+       << std::setw(12) << "rss (KB)" << '\n';
+
+    os << std::fixed;
+    for (const BenchmarkResult& r : results) {
+        os << std::left << std::setw((int) width) << r.name
+           << std::right << std::setprecision(1) << std::setw(16) << r.ns_per_op
+           << std::setw(14) << r.allocations_per_op
+           << std::setw(14) << r.bytes_per_op
+           << std::setw(14) << r.iterations
+           << std::setw(12) << r.peak_rss_kb << '\n';
+    }
+    os << std::defaultfloat;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief - The measurements of a single run of a benchmark.
+ */
+struct BenchmarkResult {
+    std::string   name;
+    std::uint64_t iterations = 0;
+    double        ns_per_op = 0;
+    double        allocations_per_op = 0;
+    double        bytes_per_op = 0;
+    long          peak_rss_kb = 0;     /// Peak RSS of the process after the run.
+};
+
+/**
+ * @brief - A named operation whose time and allocations are measured.
+ *          The setup is run once per run and returns the measured
+ *          operation, which owns the state it needs.
+ */
+class Benchmark {
+public:
+    using Operation = std::function<void()>;
+    using Setup = std::function<Operation()>;
+
+private:
+    static inline const std::uint64_t MAX_ITERATIONS = 1'000'000'000;
+
+    std::string name;
+    Setup setup;
+
+public:
+    Benchmark(std::string name, Setup setup);
+
+    const std::string& get_name() const;
+
+    /**
+     * @brief - Runs the operation once to warm up, then repeatedly
+     *          with growing iteration counts until a batch takes at least @p min_time.
+     */
+    BenchmarkResult run(std::chrono::nanoseconds min_time) const;
+};
+
+/**
+ * @returns - The peak resident set size of the process in kilobytes.
+ */
+long peak_rss_kb();
+
+/**
+ * @brief - Keeps the compiler from optimizing @p value away.
+ */
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief - Writes the results as a JSON document:
+ *          { "context": { ... }, "benchmarks": [ { "name": ..., "ns_per_op": ..., ... } ] }
+ */
+void write_json(std::ostream& os, const std::vector<BenchmarkResult>& results);
+
+/**
+ * @brief - Writes the results as a table.
+ */
+void write_table(std::ostream& os, const std::vector<BenchmarkResult>& results);
+
+/**
+ * @returns - The benchmarks of the interpreter, see Workloads.cpp.
+ */
+std::vector<Benchmark> workloads();
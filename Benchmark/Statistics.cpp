@@ -0,0 +1,59 @@
+#include "Statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+double median(std::vector<double> sample)
+{
+    if (sample.empty())
+        throw std::invalid_argument("Statistics :: median() -> Empty sample.");
+
+    std::size_t mid = sample.size() / 2;
+    std::nth_element(sample.begin(), sample.begin() + (long) mid, sample.end());
+    double upper = sample[mid];
+
+    if (sample.size() % 2)
+        return upper;
+
+    double lower = *std::max_element(sample.begin(), sample.begin() + (long) mid);
+    return (lower + upper) / 2;
+}
+
+Estimate estimate_median(const std::vector<double>& sample, double confidence, std::size_t num_resamples)
+{
+    Estimate estimate;
+    estimate.median = median(sample);
+
+    if (sample.size() == 1) {
+        estimate.low = estimate.high = estimate.median;
+        return estimate;
+    }
+
+    std::mt19937_64 generator(sample.size());
+    std::uniform_int_distribution<std::size_t> pick(0, sample.size() - 1);
+
+    std::vector<double> medians;
+    std::vector<double> resample(sample.size());
+    medians.reserve(num_resamples);
+
+    for (std::size_t i = 0; i < num_resamples; ++i) {
+        for (double& x : resample)
+            x = sample[pick(generator)];
+
+        medians.push_back(median(resample));
+    }
+
+    std::sort(medians.begin(), medians.end());
+
+    double alpha = (1 - confidence) / 2;
+    auto at = [&](double q) {
+        auto idx = (std::size_t) std::lround(q * (double) (medians.size() - 1));
+        return medians[idx];
+    };
+
+    estimate.low = at(alpha);
+    estimate.high = at(1 - alpha);
+    return estimate;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief - The median of a sample with a confidence interval for it.
+ */
+struct Estimate {
+    double median = 0;
+    double low = 0;
+    double high = 0;
+};
+
+/**
+ * @returns - The median of @p sample, which must not be empty.
+ */
+double median(std::vector<double> sample);
+
+/**
+ * @brief - Estimates the median of @p sample with a percentile bootstrap
+ *          confidence interval of the given @p confidence (0.95 for 95%).
+ *          The resampling is seeded, so equal samples give equal intervals.
+ */
+Estimate estimate_median(const std::vector<double>& sample, double confidence = 0.95,
+                         std::size_t num_resamples = 2000);
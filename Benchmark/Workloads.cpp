@@ -0,0 +1,277 @@
+#include "Benchmark.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "BigInteger.h"
+#include "Expression.h"
+#include "Literal.h"
+#include "OutputBuffer.h"
+#include "Runtime.h"
+#include "StackFrame.h"
+#include "SymbolTable.h"
+
+#ifndef FLI_RESOURCES_DIR
+#define FLI_RESOURCES_DIR "Resources"
+#endif
+
+namespace {
+
+/**
+ * @returns - An operation evaluating @p expression with @p symbol_table.
+ */
+Benchmark::Operation evaluation(std::string expression, std::shared_ptr<SymbolTable> symbol_table)
+{
+    return [expression = std::move(expression), symbol_table = std::move(symbol_table)] {
+        Expression expr(expression, *symbol_table);
+        Literal* result = expr.calculate();
+        do_not_optimize(result);
+        delete result;
+    };
+}
+
+Benchmark::Operation evaluation(std::string expression)
+{
+    return evaluation(std::move(expression), std::make_shared<SymbolTable>());
+}
+
+/**
+ * @returns - An operation calling the compiled @p expression
+ *            with the definitions of Resources/definitions.txt.
+ */
+Benchmark::Operation definitions_call(const std::string& expression)
+{
+    auto runtime = std::make_shared<Runtime>();
+    runtime->load(FLI_RESOURCES_DIR "/definitions.txt");
+    Runtime::Function function = runtime->compile(expression);
+
+    return [runtime, function] {
+        Runtime::Value result = runtime->call(function, std::span<const Runtime::Argument>());
+        do_not_optimize(result);
+    };
+}
+
+std::string numbers_list(int size)
+{
+    std::string list = "[";
+    for (int i = 0; i < size; ++i)
+        list += (i ? ", " : "") + std::to_string(i);
+
+    return list + "]";
+}
+
+}
+
+std::vector<Benchmark> workloads()
+{
+    std::vector<Benchmark> benchmarks;
+
+    ///------------------LITERAL--------------------------
+
+    benchmarks.emplace_back("literal/double_construct", [] {
+        return [] {
+            Double d(42);
+            do_not_optimize(d);
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_copy_100", [] {
+        auto list = std::make_shared<List>(0, 1, 100);
+        return [list] {
+            List copy(*list);
+            do_not_optimize(copy);
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_tail_100", [] {
+        auto list = std::make_shared<List>(0, 1, 100);
+        return [list] {
+            List tail = list->tail();
+            do_not_optimize(tail);
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_tail_infinite", [] {
+        auto list = std::make_shared<List>(0, 1);
+        return [list] {
+            List tail = list->tail();
+            do_not_optimize(tail);
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_concat_100", [] {
+        auto list = std::make_shared<List>(0, 1, 100);
+        return [list] {
+            List concat = list->concat(*list);
+            do_not_optimize(concat);
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_append_10000", [] {
+        auto element = std::make_shared<List>(std::vector<double>{1});
+        return [element] {
+            auto list = std::make_unique<List>();
+            for (int i = 0; i < 10000; ++i)
+                list = std::make_unique<List>(list->concat(*element));
+            do_not_optimize(list.get());
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_sort_100000", [] {
+        std::vector<double> numbers;
+        for (int i = 0; i < 100000; ++i)
+            numbers.push_back((i * 7919) % 100000);
+
+        auto list = std::make_shared<List>(std::move(numbers));
+        return [list] {
+            List sorted = list->sort();
+            do_not_optimize(sorted);
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_print_100000", [] {
+        std::vector<double> numbers;
+        for (int i = 0; i < 100000; ++i)
+            numbers.push_back(i / 7.0);
+
+        auto list = std::make_shared<List>(std::move(numbers));
+        auto os = std::make_shared<std::ostringstream>();
+        return [list, os] {
+            os->str("");
+            OutputBuffer(*os).write(*list);
+            do_not_optimize(*os);
+        };
+    });
+
+    benchmarks.emplace_back("literal/list_json_100000", [] {
+        std::vector<double> numbers;
+        for (int i = 0; i < 100000; ++i)
+            numbers.push_back(i / 7.0);
+
+        auto list = std::make_shared<List>(std::move(numbers));
+        auto os = std::make_shared<std::ostringstream>();
+        return [list, os] {
+            os->str("");
+            OutputBuffer(*os).write_json(*list);
+            do_not_optimize(*os);
+        };
+    });
+
+    ///------------------BIG INTEGERS--------------------------
+
+    benchmarks.emplace_back("bigint/multiply_1000_limbs", [] {
+        auto a = std::make_shared<BigInteger>(BigInteger::parse(std::string(9600, '7')));
+        auto b = std::make_shared<BigInteger>(BigInteger::parse(std::string(9600, '3')));
+        return [a, b] {
+            BigInteger product = *a * *b;
+            do_not_optimize(product);
+        };
+    });
+
+    benchmarks.emplace_back("bigint/divide_100_limbs", [] {
+        auto a = std::make_shared<BigInteger>(BigInteger::parse(std::string(1920, '7')));
+        auto b = std::make_shared<BigInteger>(BigInteger::parse(std::string(960, '3')));
+        return [a, b] {
+            BigInteger remainder = *a % *b;
+            do_not_optimize(remainder);
+        };
+    });
+
+    benchmarks.emplace_back("bigint/to_string_100_limbs", [] {
+        auto a = std::make_shared<BigInteger>(BigInteger::parse(std::string(960, '7')));
+        return [a] {
+            std::string digits = a->to_string();
+            do_not_optimize(digits);
+        };
+    });
+
+    ///------------------PARSING--------------------------
+
+    benchmarks.emplace_back("parse/number", [] {
+        return evaluation("12345.6789");
+    });
+
+    benchmarks.emplace_back("parse/exponent_and_hex", [] {
+        return evaluation("1.5e-3 + 0x1.8p3 + 0xFF");
+    });
+
+    benchmarks.emplace_back("parse/list_100", [] {
+        return evaluation(numbers_list(100));
+    });
+
+    benchmarks.emplace_back("parse/nested_list", [] {
+        return evaluation("[[1, 2, [3, 4]], [5, [6, [7, 8]]], 9]");
+    });
+
+    ///------------------BUILTINS--------------------------
+
+    benchmarks.emplace_back("builtin/add", [] {
+        return evaluation("add(1, 2)");
+    });
+
+    benchmarks.emplace_back("builtin/operators", [] {
+        return evaluation("1 + 2 * 3 - 4 / 5 ^ 2");
+    });
+
+    benchmarks.emplace_back("builtin/integer_arithmetic", [] {
+        return evaluation("123456789 * 987654321 % 1000000007 + 2147483647 * 3 - int(7.5)");
+    });
+
+    benchmarks.emplace_back("builtin/if_nand", [] {
+        return evaluation("if(nand(1, 0), sqrt(16), 0)");
+    });
+
+    benchmarks.emplace_back("builtin/list_functions", [] {
+        return evaluation("length(tail(concat(list(1, 1, 10), [head(list(1))])))");
+    });
+
+    ///------------------USER FUNCTIONS--------------------------
+
+    benchmarks.emplace_back("call/stack_frame", [] {
+        auto symbol_table = std::make_shared<SymbolTable>();
+        auto argument = std::make_shared<Double>(1);
+
+        return [symbol_table, argument] {
+            StackFrame frame("#0", {argument.get()}, *symbol_table);
+            Task<std::unique_ptr<Literal>> task = frame.evaluate();
+            task.resume();
+            std::unique_ptr<Literal> result = task.get();
+            do_not_optimize(result.get());
+        };
+    });
+
+    benchmarks.emplace_back("call/identity", [] {
+        auto symbol_table = std::make_shared<SymbolTable>();
+        symbol_table->add_definition("id", {1, "#0"});
+        return evaluation("id(1)", symbol_table);
+    });
+
+    benchmarks.emplace_back("call/recursion_100", [] {
+        auto symbol_table = std::make_shared<SymbolTable>();
+        symbol_table->add_definition("count", {1, "if(#0, count(#0 - 1), 0)"});
+        return evaluation("count(100)", symbol_table);
+    });
+
+    benchmarks.emplace_back("call/factorial_300", [] {
+        auto symbol_table = std::make_shared<SymbolTable>();
+        symbol_table->add_definition("fact", {1, "if(#0, #0 * fact(#0 - 1), 1)"});
+        return evaluation("fact(300)", symbol_table);
+    });
+
+    ///------------------END TO END--------------------------
+
+    benchmarks.emplace_back("e2e/primes10", [] {
+        return definitions_call("primes10()");
+    });
+
+    benchmarks.emplace_back("e2e/filterPrimes_1000", [] {
+        return definitions_call("filterPrimes(list(2, 1, 1000))");
+    });
+
+    benchmarks.emplace_back("e2e/filterPrimes_2000", [] {
+        return definitions_call("filterPrimes(list(2, 1, 2000))");
+    });
+
+    return benchmarks;
+}
@@ -0,0 +1,85 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Benchmark.h"
+
+/**
+ * @brief - Runs the benchmarks of the interpreter.
+ *
+ *          Options:
+ *              --filter <text>     Only runs the benchmarks whose name contains text.
+ *              --min-time <ms>     Minimal duration of the measured batch, 200 by default.
+ *              --json <path>       Also writes the results as JSON to path, "-" for stdout.
+ *              --list              Lists the benchmarks.
+ *
+ *          Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string json_path;
+    long min_time_ms = 200;
+    bool list = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (!std::strcmp(argv[i], "--filter") && i + 1 < argc)
+                filter = argv[++i];
+            else if (!std::strcmp(argv[i], "--min-time") && i + 1 < argc)
+                min_time_ms = std::stol(argv[++i]);
+            else if (!std::strcmp(argv[i], "--json") && i + 1 < argc)
+                json_path = argv[++i];
+            else if (!std::strcmp(argv[i], "--list"))
+                list = true;
+            else
+                throw std::invalid_argument(std::string("Unknown option: ") + argv[i]);
+        }
+    } catch (std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+
+    std::vector<BenchmarkResult> results;
+
+    try {
+        for (const Benchmark& benchmark : workloads()) {
+            if (benchmark.get_name().find(filter) == std::string::npos)
+                continue;
+
+            if (list) {
+                std::cout << benchmark.get_name() << '\n';
+                continue;
+            }
+
+            results.push_back(benchmark.run(std::chrono::milliseconds(min_time_ms)));
+            if (json_path != "-")
+                std::cerr << "> " << benchmark.get_name() << '\n';
+        }
+    } catch (std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    if (list)
+        return 0;
+
+    if (json_path == "-") {
+        write_json(std::cout, results);
+        return 0;
+    }
+
+    write_table(std::cout, results);
+
+    if (!json_path.empty()) {
+        std::ofstream ofs(json_path);
+        write_json(ofs, results);
+        if (!ofs) {
+            std::cerr << "Cannot write " << json_path << '\n';
+            return 1;
+        }
+    }
+
+    return 0;
+}
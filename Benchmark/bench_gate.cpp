@@ -0,0 +1,148 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Baseline.h"
+#include "Benchmark.h"
+#include "Statistics.h"
+
+#ifndef FLI_BUILD_TYPE
+#define FLI_BUILD_TYPE ""
+#endif
+
+/**
+ * @brief - Runs the benchmarks several times and compares them to a baseline.
+ *
+ *          A benchmark regresses when its median time is more than the
+ *          threshold above the baseline's median and the confidence
+ *          intervals of the two medians do not overlap, or when it
+ *          allocates more than the threshold above the baseline.
+ *          Exits with 1 if any benchmark regressed.
+ *
+ *          Options:
+ *              --baseline <path>   The baseline, Benchmark/baseline.json by default.
+ *              --runs <n>          Runs of every benchmark, 5 by default.
+ *              --threshold <pct>   Tolerated slowdown in percent, 10 by default.
+ *              --min-time <ms>     Minimal duration of a run, 100 by default.
+ *              --filter <text>     Only runs the benchmarks whose name contains text.
+ *              --update            Writes the measurements as the new baseline instead.
+ */
+int main(int argc, char** argv)
+{
+    std::string baseline_path = FLI_BASELINE;
+    std::string filter;
+    std::size_t runs = 5;
+    double threshold = 10;
+    long min_time_ms = 100;
+    bool update = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (!std::strcmp(argv[i], "--baseline") && i + 1 < argc)
+                baseline_path = argv[++i];
+            else if (!std::strcmp(argv[i], "--runs") && i + 1 < argc)
+                runs = std::stoul(argv[++i]);
+            else if (!std::strcmp(argv[i], "--threshold") && i + 1 < argc)
+                threshold = std::stod(argv[++i]);
+            else if (!std::strcmp(argv[i], "--min-time") && i + 1 < argc)
+                min_time_ms = std::stol(argv[++i]);
+            else if (!std::strcmp(argv[i], "--filter") && i + 1 < argc)
+                filter = argv[++i];
+            else if (!std::strcmp(argv[i], "--update"))
+                update = true;
+            else
+                throw std::invalid_argument(std::string("Unknown option: ") + argv[i]);
+        }
+
+        if (!runs)
+            throw std::invalid_argument("--runs must be positive");
+    } catch (std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+
+    try {
+        Baseline baseline;
+        if (!update) {
+            baseline = Baseline::read(baseline_path);
+            if (baseline.build_type != FLI_BUILD_TYPE)
+                std::cerr << "> Warning: the baseline was recorded with build type \"" << baseline.build_type
+                          << "\", this is \"" << FLI_BUILD_TYPE << "\"\n";
+        }
+
+        Baseline current;
+        current.build_type = FLI_BUILD_TYPE;
+        current.runs = runs;
+
+        std::vector<Benchmark> benchmarks = workloads();
+        std::size_t regressions = 0;
+
+        std::cout << std::fixed << std::setprecision(1);
+
+        for (const Benchmark& benchmark : benchmarks) {
+            if (benchmark.get_name().find(filter) == std::string::npos)
+                continue;
+
+            std::vector<double> times;
+            BaselineEntry entry;
+
+            for (std::size_t run = 0; run < runs; ++run) {
+                BenchmarkResult result = benchmark.run(std::chrono::milliseconds(min_time_ms));
+                times.push_back(result.ns_per_op);
+                entry.allocations_per_op = result.allocations_per_op;
+            }
+
+            entry.ns_per_op = estimate_median(times);
+            current.benchmarks[benchmark.get_name()] = entry;
+
+            std::cout << benchmark.get_name() << ": " << entry.ns_per_op.median << " ns/op ["
+                      << entry.ns_per_op.low << ", " << entry.ns_per_op.high << "]";
+
+            if (update) {
+                std::cout << '\n';
+                continue;
+            }
+
+            auto it = baseline.benchmarks.find(benchmark.get_name());
+            if (it == baseline.benchmarks.end()) {
+                std::cout << " - not in the baseline\n";
+                continue;
+            }
+
+            const BaselineEntry& base = it->second;
+            double change = 100 * (entry.ns_per_op.median / base.ns_per_op.median - 1);
+            bool slower = change > threshold && entry.ns_per_op.low > base.ns_per_op.high;
+            /// Allocation counts are exact, up to the odd allocation outside the operation.
+            bool allocates_more = entry.allocations_per_op > base.allocations_per_op * (1 + threshold / 100) + 0.5;
+
+            std::cout << " vs " << base.ns_per_op.median << " (" << std::showpos << change << "%" << std::noshowpos << ")";
+            if (slower)
+                std::cout << " - REGRESSION";
+            if (allocates_more)
+                std::cout << " - ALLOCATION REGRESSION (" << base.allocations_per_op << " -> "
+                          << entry.allocations_per_op << " allocs/op)";
+            std::cout << '\n';
+
+            regressions += slower || allocates_more;
+        }
+
+        if (update) {
+            current.write(baseline_path);
+            std::cout << "> Wrote " << baseline_path << '\n';
+            return 0;
+        }
+
+        if (regressions) {
+            std::cout << "> " << regressions << " benchmark(s) regressed by more than " << threshold << "%\n";
+            return 1;
+        }
+
+        std::cout << "> No regressions\n";
+    } catch (std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+
+    return 0;
+}
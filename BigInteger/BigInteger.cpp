@@ -0,0 +1,549 @@
+#include "BigInteger.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+namespace {
+
+using limb = BigInteger::limb;
+using Limbs = std::vector<limb>;
+using Span = std::span<const limb>;
+
+constexpr std::uint64_t BASE = std::uint64_t(1) << 32;
+
+/// The largest power of 10 in a limb, the digits are converted 9 at a time.
+constexpr limb DECIMAL_BASE = 1000000000;
+constexpr int DECIMAL_DIGITS = 9;
+
+void trim(Limbs& a)
+{
+    while (!a.empty() && a.back() == 0)
+        a.pop_back();
+}
+
+Span trimmed(Span a)
+{
+    while (!a.empty() && a.back() == 0)
+        a = a.first(a.size() - 1);
+
+    return a;
+}
+
+int compare(Span a, Span b)
+{
+    a = trimmed(a);
+    b = trimmed(b);
+
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+
+    for (std::size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+Limbs add(Span a, Span b)
+{
+    if (a.size() < b.size())
+        std::swap(a, b);
+
+    Limbs result(a.size() + 1);
+    std::uint64_t carry = 0;
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::uint64_t sum = (std::uint64_t) a[i] + (i < b.size() ? b[i] : 0) + carry;
+        result[i] = (limb) sum;
+        carry = sum >> 32;
+    }
+
+    result[a.size()] = (limb) carry;
+    trim(result);
+    return result;
+}
+
+/**
+ * @returns - @p a - @p b, for @p a >= @p b.
+ */
+Limbs subtract(Span a, Span b)
+{
+    Limbs result(a.size());
+    std::int64_t borrow = 0;
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::int64_t difference = (std::int64_t) a[i] - (i < b.size() ? b[i] : 0) - borrow;
+        borrow = difference < 0;
+        result[i] = (limb) (difference + (borrow ? (std::int64_t) BASE : 0));
+    }
+
+    trim(result);
+    return result;
+}
+
+/**
+ * @brief - Adds @p a shifted by @p shift limbs to @p result, which is large enough for the sum.
+ */
+void add_to(Limbs& result, Span a, std::size_t shift)
+{
+    std::uint64_t carry = 0;
+    std::size_t i = 0;
+
+    for (; i < a.size(); ++i) {
+        std::uint64_t sum = (std::uint64_t) result[i + shift] + a[i] + carry;
+        result[i + shift] = (limb) sum;
+        carry = sum >> 32;
+    }
+
+    for (std::size_t k = i + shift; carry; ++k) {
+        std::uint64_t sum = (std::uint64_t) result[k] + carry;
+        result[k] = (limb) sum;
+        carry = sum >> 32;
+    }
+}
+
+Limbs schoolbook(Span a, Span b)
+{
+    Limbs result(a.size() + b.size());
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::uint64_t carry = 0;
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            std::uint64_t product = (std::uint64_t) a[i] * b[j] + result[i + j] + carry;
+            result[i + j] = (limb) product;
+            carry = product >> 32;
+        }
+
+        result[i + b.size()] = (limb) carry;
+    }
+
+    trim(result);
+    return result;
+}
+
+/**
+ * @brief - Karatsuba multiplication: with a = a1 * B + a0 and b = b1 * B + b0,
+ *          a * b = a1 * b1 * B^2 + ((a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1) * B + a0 * b0,
+ *          three products of halves instead of four.
+ */
+Limbs multiply(Span a, Span b)
+{
+    a = trimmed(a);
+    b = trimmed(b);
+
+    if (a.size() < b.size())
+        std::swap(a, b);
+
+    if (b.size() < BigInteger::KARATSUBA_THRESHOLD)
+        return schoolbook(a, b);
+
+    std::size_t half = a.size() / 2;
+    Span a0 = a.first(half);
+    Span a1 = a.subspan(half);
+
+    Limbs result(a.size() + b.size() + 1);
+
+    /// An operand shorter than half of the other one is not split.
+    if (b.size() <= half) {
+        add_to(result, multiply(a0, b), 0);
+        add_to(result, multiply(a1, b), half);
+        trim(result);
+        return result;
+    }
+
+    Span b0 = b.first(half);
+    Span b1 = b.subspan(half);
+
+    Limbs low = multiply(a0, b0);
+    Limbs high = multiply(a1, b1);
+    Limbs middle = subtract(subtract(multiply(add(a0, a1), add(b0, b1)), low), high);
+
+    add_to(result, low, 0);
+    add_to(result, middle, half);
+    add_to(result, high, 2 * half);
+    trim(result);
+    return result;
+}
+
+/**
+ * @returns - The quotient and the remainder of @p a divided by the single limb @p b.
+ */
+std::pair<Limbs, limb> divide(Span a, limb b)
+{
+    Limbs quotient(a.size());
+    std::uint64_t remainder = 0;
+
+    for (std::size_t i = a.size(); i-- > 0;) {
+        std::uint64_t current = (remainder << 32) | a[i];
+        quotient[i] = (limb) (current / b);
+        remainder = current % b;
+    }
+
+    trim(quotient);
+    return {std::move(quotient), (limb) remainder};
+}
+
+/**
+ * @returns - The quotient and the remainder of @p a divided by @p b, which is not 0,
+ *            by Knuth's algorithm D.
+ */
+std::pair<Limbs, Limbs> divide(Span a, Span b)
+{
+    a = trimmed(a);
+    b = trimmed(b);
+
+    if (compare(a, b) < 0)
+        return {{}, Limbs(a.begin(), a.end())};
+
+    if (b.size() == 1) {
+        auto [quotient, remainder] = divide(a, b[0]);
+        return {std::move(quotient), remainder ? Limbs{remainder} : Limbs{}};
+    }
+
+    /// Shifts both so that the top limb of the divisor has its top bit set,
+    /// which keeps the estimates of the quotient limbs off by at most 2.
+    int shift = std::countl_zero(b.back());
+    std::size_t n = b.size();
+    std::size_t m = a.size() - n;
+
+    Limbs v(n);
+    Limbs u(a.size() + 1);
+
+    for (std::size_t i = n; i-- > 0;)
+        v[i] = (b[i] << shift) | (shift && i ? b[i - 1] >> (32 - shift) : 0);
+
+    u[a.size()] = shift ? a.back() >> (32 - shift) : 0;
+    for (std::size_t i = a.size(); i-- > 0;)
+        u[i] = (a[i] << shift) | (shift && i ? a[i - 1] >> (32 - shift) : 0);
+
+    Limbs quotient(m + 1);
+
+    for (std::size_t j = m + 1; j-- > 0;) {
+        std::uint64_t numerator = ((std::uint64_t) u[j + n] << 32) | u[j + n - 1];
+        std::uint64_t estimate = numerator / v[n - 1];
+        std::uint64_t rest = numerator % v[n - 1];
+
+        while (estimate >= BASE || estimate * v[n - 2] > ((rest << 32) | u[j + n - 2])) {
+            --estimate;
+            rest += v[n - 1];
+            if (rest >= BASE)
+                break;
+        }
+
+        /// Subtracts the estimate times the divisor.
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint64_t product = estimate * v[i];
+            std::int64_t difference = (std::int64_t) u[i + j] - borrow - (std::int64_t) (product & 0xFFFFFFFF);
+            u[i + j] = (limb) difference;
+            borrow = (std::int64_t) (product >> 32) - (difference >> 32);
+        }
+
+        std::int64_t top = (std::int64_t) u[j + n] - borrow;
+        u[j + n] = (limb) top;
+
+        /// The estimate was one too large, adds the divisor back.
+        if (top < 0) {
+            --estimate;
+
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint64_t sum = (std::uint64_t) u[i + j] + v[i] + carry;
+                u[i + j] = (limb) sum;
+                carry = sum >> 32;
+            }
+
+            u[j + n] += (limb) carry;
+        }
+
+        quotient[j] = (limb) estimate;
+    }
+
+    Limbs remainder(n);
+    for (std::size_t i = 0; i < n; ++i)
+        remainder[i] = (u[i] >> shift) | (shift ? u[i + 1] << (32 - shift) : 0);
+
+    trim(quotient);
+    trim(remainder);
+    return {std::move(quotient), std::move(remainder)};
+}
+
+}
+
+BigInteger::BigInteger(std::int64_t value)
+        : small(value)
+{}
+
+BigInteger::BigInteger(std::vector<limb> magnitude, bool negative)
+{
+    trim(magnitude);
+
+    if (magnitude.size() <= 2) {
+        std::uint64_t value = magnitude.empty() ? 0 : magnitude[0];
+        if (magnitude.size() == 2)
+            value |= (std::uint64_t) magnitude[1] << 32;
+
+        constexpr std::uint64_t MAX = std::numeric_limits<std::int64_t>::max();
+        if (value <= MAX) {
+            small = negative ? -(std::int64_t) value : (std::int64_t) value;
+            return;
+        }
+
+        if (negative && value == MAX + 1) {
+            small = std::numeric_limits<std::int64_t>::min();
+            return;
+        }
+    }
+
+    limbs = std::move(magnitude);
+    this->negative = negative;
+}
+
+std::vector<BigInteger::limb> BigInteger::magnitude(const BigInteger& x)
+{
+    if (!x.is_small())
+        return x.limbs;
+
+    std::uint64_t value = x.small < 0 ? 0 - (std::uint64_t) x.small : (std::uint64_t) x.small;
+    Limbs result{(limb) value, (limb) (value >> 32)};
+    trim(result);
+    return result;
+}
+
+BigInteger BigInteger::parse(std::string_view digits, int base)
+{
+    assert(base == 10 || base == 16);
+
+    bool negative = !digits.empty() && digits.front() == '-';
+    if (negative)
+        digits.remove_prefix(1);
+
+    auto value_of = [base](char c) {
+        int value = '0' <= c && c <= '9' ? c - '0'
+                  : 'a' <= c && c <= 'f' ? c - 'a' + 10
+                  : 'A' <= c && c <= 'F' ? c - 'A' + 10
+                  : base;
+        return value < base ? value : -1;
+    };
+
+    if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [&](char c) { return value_of(c) != -1; }))
+        throw std::invalid_argument("BigInteger :: parse() -> Not an integer: " + std::string(digits));
+
+    Limbs result;
+
+    /// The most digits whose value fits in a limb, the first chunk takes the ones left over.
+    std::size_t chunk_digits = base == 10 ? DECIMAL_DIGITS : 7;
+    std::size_t chunk = digits.size() % chunk_digits ? digits.size() % chunk_digits : chunk_digits;
+
+    for (std::size_t i = 0; i < digits.size(); i += chunk, chunk = chunk_digits) {
+        limb value = 0;
+        limb scale = 1;
+        for (std::size_t k = i; k < i + chunk; ++k) {
+            value = value * base + value_of(digits[k]);
+            scale *= base;
+        }
+
+        /// result = result * scale + value
+        std::uint64_t carry = value;
+        for (limb& l : result) {
+            std::uint64_t current = (std::uint64_t) l * scale + carry;
+            l = (limb) current;
+            carry = current >> 32;
+        }
+
+        if (carry)
+            result.push_back((limb) carry);
+    }
+
+    return {std::move(result), negative};
+}
+
+double BigInteger::to_double() const
+{
+    if (is_small())
+        return (double) small;
+
+    double result = 0;
+    for (std::size_t i = limbs.size(); i-- > 0;)
+        result = result * (double) BASE + limbs[i];
+
+    return negative ? -result : result;
+}
+
+BigInteger BigInteger::from_double(double value)
+{
+    if (!std::isfinite(value) || value != std::trunc(value))
+        throw std::invalid_argument("BigInteger :: from_double() -> Expected a finite integer, given " +
+                                    std::to_string(value) + ".");
+
+    if (std::abs(value) < 0x1p63)
+        return (std::int64_t) value;
+
+    /// value = mantissa * 2^exponent, with a mantissa of 53 bits.
+    int exponent;
+    double fraction = std::frexp(value, &exponent);
+    BigInteger result = (std::int64_t) std::ldexp(fraction, 53);
+
+    for (exponent -= 53; exponent >= 32; exponent -= 32)
+        result = result * ((std::int64_t) 1 << 32);
+    return result * ((std::int64_t) 1 << exponent);
+}
+
+double BigInteger::ratio(const BigInteger& a, const BigInteger& b)
+{
+    /// Exact as doubles, so the quotient is rounded once.
+    auto exact = [](const BigInteger& x) { return x.is_small() && x.small >= -(1LL << 53) && x.small <= (1LL << 53); };
+    if (exact(a) && exact(b) || b.is_zero())
+        return a.to_double() / b.to_double();
+
+    /// Scaled by 2^(32 k), so the quotient has at least 64 significant bits.
+    Limbs numerator = magnitude(a);
+    Limbs denominator = magnitude(b);
+    std::size_t k = numerator.size() < denominator.size() + 3 ? denominator.size() + 3 - numerator.size() : 0;
+    numerator.insert(numerator.begin(), k, 0);
+
+    BigInteger quotient = BigInteger(std::move(numerator), a.is_negative() != b.is_negative()) /
+                          BigInteger(std::move(denominator), false);
+    return std::ldexp(quotient.to_double(), -32 * (int) k);
+}
+
+std::string BigInteger::to_string() const
+{
+    if (is_small())
+        return std::to_string(small);
+
+    /// Collects the digits 9 at a time, from the least significant.
+    std::vector<limb> chunks;
+    Limbs rest = limbs;
+    while (!rest.empty()) {
+        auto [quotient, remainder] = divide(rest, DECIMAL_BASE);
+        chunks.push_back(remainder);
+        rest = std::move(quotient);
+    }
+
+    std::string result = negative ? "-" : "";
+    result += std::to_string(chunks.back());
+
+    for (std::size_t i = chunks.size() - 1; i-- > 0;) {
+        std::string chunk = std::to_string(chunks[i]);
+        result.append(DECIMAL_DIGITS - chunk.size(), '0');
+        result += chunk;
+    }
+
+    return result;
+}
+
+BigInteger BigInteger::operator-() const
+{
+    if (is_small() && small != std::numeric_limits<std::int64_t>::min())
+        return -small;
+
+    return {magnitude(*this), !is_negative()};
+}
+
+BigInteger BigInteger::add(const BigInteger& a, const BigInteger& b, bool subtract)
+{
+    Limbs x = magnitude(a);
+    Limbs y = magnitude(b);
+    bool x_negative = a.is_negative();
+    bool y_negative = b.is_negative() != subtract;
+
+    if (x_negative == y_negative)
+        return {::add(x, y), x_negative};
+
+    if (compare(x, y) >= 0)
+        return {::subtract(x, y), x_negative};
+
+    return {::subtract(y, x), y_negative};
+}
+
+BigInteger operator+(const BigInteger& a, const BigInteger& b)
+{
+    std::int64_t result;
+    if (a.is_small() && b.is_small() && !__builtin_add_overflow(a.small, b.small, &result))
+        return result;
+
+    return BigInteger::add(a, b, false);
+}
+
+BigInteger operator-(const BigInteger& a, const BigInteger& b)
+{
+    std::int64_t result;
+    if (a.is_small() && b.is_small() && !__builtin_sub_overflow(a.small, b.small, &result))
+        return result;
+
+    return BigInteger::add(a, b, true);
+}
+
+BigInteger operator*(const BigInteger& a, const BigInteger& b)
+{
+    std::int64_t result;
+    if (a.is_small() && b.is_small() && !__builtin_mul_overflow(a.small, b.small, &result))
+        return result;
+
+    return {multiply(BigInteger::magnitude(a), BigInteger::magnitude(b)), a.is_negative() != b.is_negative()};
+}
+
+BigInteger operator/(const BigInteger& a, const BigInteger& b)
+{
+    if (b.is_zero())
+        throw std::invalid_argument("BigInteger :: Division by zero.");
+
+    /// The minimum integer divided by -1 overflows.
+    if (a.is_small() && b.is_small() && b.small != -1)
+        return a.small / b.small;
+
+    if (b.is_small() && b.small == -1)
+        return -a;
+
+    return {divide(BigInteger::magnitude(a), BigInteger::magnitude(b)).first, a.is_negative() != b.is_negative()};
+}
+
+BigInteger operator%(const BigInteger& a, const BigInteger& b)
+{
+    if (b.is_zero())
+        throw std::invalid_argument("BigInteger :: Division by zero.");
+
+    if (b.is_small() && (b.small == -1 || b.small == 1))
+        return 0;
+
+    if (a.is_small() && b.is_small())
+        return a.small % b.small;
+
+    return {divide(BigInteger::magnitude(a), BigInteger::magnitude(b)).second, a.is_negative()};
+}
+
+bool operator==(const BigInteger& a, const BigInteger& b)
+{
+    /// Values fitting in 64 bits are always stored inline.
+    return a.small == b.small && a.negative == b.negative && a.limbs == b.limbs;
+}
+
+std::strong_ordering operator<=>(const BigInteger& a, const BigInteger& b)
+{
+    if (a.is_small() && b.is_small())
+        return a.small <=> b.small;
+
+    if (a.is_negative() != b.is_negative())
+        return a.is_negative() ? std::strong_ordering::less : std::strong_ordering::greater;
+
+    int order = compare(BigInteger::magnitude(a), BigInteger::magnitude(b));
+    if (a.is_negative())
+        order = -order;
+
+    return order <=> 0;
+}
+
+std::ostream& operator<<(std::ostream& os, const BigInteger& x)
+{
+    if (x.is_small())
+        return os << x.small;
+
+    return os << x.to_string();
+}
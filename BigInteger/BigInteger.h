@@ -0,0 +1,120 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief - Integer of any size, for exact arithmetic past 64 bits.
+ *
+ *          Values fitting in 64 bits are stored inline and computed with
+ *          the machine instructions, checking for overflow. The others are
+ *          stored as their magnitude in 32-bit limbs, least significant
+ *          first, and their sign. Products of large operands are computed
+ *          by Karatsuba multiplication.
+ *          Division truncates towards zero, as it does for int64_t.
+ */
+class BigInteger {
+public:
+    using limb = std::uint32_t;
+
+    /// Operands of at least this many limbs are multiplied by Karatsuba multiplication.
+    static constexpr std::size_t KARATSUBA_THRESHOLD = 32;
+
+private:
+    /// The value when it fits in 64 bits, then there are no limbs.
+    std::int64_t small = 0;
+
+    std::vector<limb> limbs;
+    bool negative = false;
+
+    /**
+     * @brief - Stores the value inline if it fits in 64 bits.
+     */
+    BigInteger(std::vector<limb> magnitude, bool negative);
+
+    static std::vector<limb> magnitude(const BigInteger& x);
+    static BigInteger add(const BigInteger& a, const BigInteger& b, bool subtract);
+
+public:
+    BigInteger(std::int64_t value = 0);
+
+    /**
+     * @returns - The integer written in @p digits, with an optional leading '-',
+     *            in decimal or, with @p base 16, in hexadecimal.
+     *
+     * @throws std::invalid_argument - If @p digits is not an integer.
+     */
+    static BigInteger parse(std::string_view digits, int base = 10);
+
+    /**
+     * @returns - The value of the integral double @p value, exactly.
+     *
+     * @throws std::invalid_argument - If @p value is not a finite integer.
+     */
+    static BigInteger from_double(double value);
+
+    bool is_small() const
+    {
+        return limbs.empty();
+    }
+
+    /**
+     * @returns - The value, when is_small().
+     */
+    std::int64_t get_small() const
+    {
+        return small;
+    }
+
+    bool is_negative() const
+    {
+        return is_small() ? small < 0 : negative;
+    }
+
+    bool is_zero() const
+    {
+        return is_small() && small == 0;
+    }
+
+    /**
+     * @returns - The number of limbs allocated, 0 when is_small().
+     */
+    std::size_t size() const
+    {
+        return limbs.size();
+    }
+
+    /**
+     * @returns - The nearest double, infinite if the value is too large for one.
+     */
+    double to_double() const;
+    std::string to_string() const;
+
+    BigInteger operator-() const;
+
+    friend BigInteger operator+(const BigInteger& a, const BigInteger& b);
+    friend BigInteger operator-(const BigInteger& a, const BigInteger& b);
+    friend BigInteger operator*(const BigInteger& a, const BigInteger& b);
+
+    /**
+     * @throws std::invalid_argument - If @p b is 0.
+     */
+    friend BigInteger operator/(const BigInteger& a, const BigInteger& b);
+    friend BigInteger operator%(const BigInteger& a, const BigInteger& b);
+
+    /**
+     * @returns - @p a / @p b as a double, also when the operands are too large
+     *            for doubles, infinite or NaN if @p b is 0 as for doubles.
+     */
+    static double ratio(const BigInteger& a, const BigInteger& b);
+
+    friend bool operator==(const BigInteger& a, const BigInteger& b);
+    friend std::strong_ordering operator<=>(const BigInteger& a, const BigInteger& b);
+
+    friend std::ostream& operator<<(std::ostream& os, const BigInteger& x);
+};
@@ -0,0 +1,107 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ *                  DOCUMENTATION
+ *
+ * Client for the interpreter's server mode, used for testing.
+ *
+ * Usage: Client <socket path>
+ *
+ * Every line read from the standard input is sent to the server as
+ * a request and the response is printed before the next line is sent.
+ * Errors reported by the server are printed to the standard error.
+ */
+
+namespace {
+    const std::string END_OF_RESPONSE = ".";
+    const std::string ERROR_PREFIX = "! ";
+
+    bool send_all(int fd, const std::string& data)
+    {
+        std::size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    /**
+     * @brief - Prints the lines of a response until its end.
+     *
+     * @returns - false if the connection was closed.
+     */
+    bool print_response(int fd, std::string& buffer)
+    {
+        char chunk[4096];
+
+        while (true) {
+            std::size_t end;
+            while ((end = buffer.find('\n')) != std::string::npos) {
+                std::string line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+
+                if (line == END_OF_RESPONSE)
+                    return true;
+
+                if (line.compare(0, ERROR_PREFIX.size(), ERROR_PREFIX) == 0)
+                    std::cerr << line.substr(ERROR_PREFIX.size()) << '\n';
+                else
+                    std::cout << line << '\n';
+            }
+
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+
+            buffer.append(chunk, n);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket path>\n";
+        return 2;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (std::strlen(argv[1]) >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path is too long.\n";
+        return 2;
+    }
+    std::strcpy(address.sun_path, argv[1]);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (sockaddr*) &address, sizeof(address)) < 0) {
+        std::cerr << "Cannot connect to " << argv[1] << ": " << std::strerror(errno) << '\n';
+        return 1;
+    }
+
+    std::string buffer;
+    std::string line;
+
+    while (std::getline(std::cin, line)) {
+        if (!send_all(fd, line + '\n') || !print_response(fd, buffer))
+            break;
+    }
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+/**
+ * @brief - A lazily started coroutine producing a value of type T.
+ *
+ *          Awaiting a task starts it and the awaiting coroutine is resumed
+ *          when the task finishes. The coroutines do not resume each other,
+ *          they hand the next coroutine to a loop which resumes it
+ *          (a trampoline), so a chain of tasks awaiting each other does not
+ *          grow the native stack, even without tail call optimization.
+ *
+ *          A task which is not awaited by another one is driven with
+ *          resume(), which returns when the task finishes or suspends.
+ *          The exception a task fails with is rethrown by await_resume()
+ *          and get().
+ */
+template<typename T = void>
+class Task;
+
+namespace task_detail {
+
+    /// The coroutine the trampoline of the current thread resumes next.
+    inline thread_local std::coroutine_handle<> next{};
+
+    /**
+     * @brief - Resumes @p handle and every coroutine handed over after it,
+     *          until none is left.
+     */
+    inline void run(std::coroutine_handle<> handle)
+    {
+        std::coroutine_handle<> outer = std::exchange(next, handle);
+
+        while (next)
+            std::exchange(next, {}).resume();
+
+        next = outer;
+    }
+
+    /**
+     * @brief - Hands the coroutine awaiting the finished task, if any, to the trampoline.
+     */
+    struct FinalAwaiter {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+        {
+            next = handle.promise().continuation;
+        }
+
+        void await_resume() const noexcept
+        {}
+    };
+
+    struct PromiseBase {
+        std::coroutine_handle<> continuation{};
+        std::exception_ptr      error{};
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        FinalAwaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void unhandled_exception() noexcept
+        {
+            error = std::current_exception();
+        }
+
+        void rethrow_error() const
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase {
+        T value{};
+
+        Task<T> get_return_object() noexcept;
+
+        void return_value(T result)
+        {
+            value = std::move(result);
+        }
+
+        T take()
+        {
+            rethrow_error();
+            return std::move(value);
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase {
+        Task<void> get_return_object() noexcept;
+
+        void return_void() const noexcept
+        {}
+
+        void take() const
+        {
+            rethrow_error();
+        }
+    };
+}
+
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = task_detail::Promise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle{};
+
+public:
+    Task() = default;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+            : handle(handle)
+    {}
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+            : handle(std::exchange(other.handle, {}))
+    {}
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    ~Task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        task_detail::next = handle;
+    }
+
+    T await_resume()
+    {
+        return handle.promise().take();
+    }
+
+    /**
+     * @returns - Whether the task refers to a coroutine.
+     */
+    bool valid() const noexcept
+    {
+        return (bool) handle;
+    }
+
+    /**
+     * @brief - Starts the task, returns when it finishes or suspends.
+     */
+    void resume()
+    {
+        task_detail::run(handle);
+    }
+
+    bool done() const noexcept
+    {
+        return handle.done();
+    }
+
+    /**
+     * @returns - The value of the finished task.
+     *
+     * @throws - The exception the task failed with.
+     */
+    T get()
+    {
+        return handle.promise().take();
+    }
+};
+
+namespace task_detail {
+
+    template<typename T>
+    Task<T> Promise<T>::get_return_object() noexcept
+    {
+        return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> Promise<void>::get_return_object() noexcept
+    {
+        return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+}
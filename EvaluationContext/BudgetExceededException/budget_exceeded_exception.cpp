@@ -0,0 +1,5 @@
+#include "budget_exceeded_exception.h"
+
+budget_exceeded_exception::budget_exceeded_exception(const std::string& message)
+        : std::runtime_error(message)
+{}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief - This exception is thrown when an evaluation
+ *          exceeds one of the limits of its budget.
+ */
+class budget_exceeded_exception : public std::runtime_error {
+public:
+    explicit budget_exceeded_exception(const std::string& message);
+};
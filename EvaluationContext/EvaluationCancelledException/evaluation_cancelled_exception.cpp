@@ -0,0 +1,6 @@
+#include "evaluation_cancelled_exception.h"
+
+const char* evaluation_cancelled_exception::what() const noexcept
+{
+    return "Evaluation :: Cancelled.";
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdexcept>
+
+/**
+ * @brief - This exception is thrown when an evaluation
+ *          notices that it was cancelled.
+ */
+class evaluation_cancelled_exception : public std::exception {
+public:
+    const char* what() const noexcept override;
+};
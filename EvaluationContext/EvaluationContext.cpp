@@ -0,0 +1,184 @@
+#include "EvaluationContext.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "budget_exceeded_exception.h"
+#include "evaluation_cancelled_exception.h"
+#include "Task.h"
+
+EvaluationContext::EvaluationContext(std::istream& input, std::ostream& output)
+        : input(&input),
+          output(output)
+{}
+
+std::istream& EvaluationContext::get_input()
+{
+    return *input;
+}
+
+std::ostream& EvaluationContext::get_output()
+{
+    output.flush();
+    return output.get_stream();
+}
+
+void EvaluationContext::flush_output()
+{
+    output.flush();
+}
+
+void EvaluationContext::set_suspend_on_read(bool suspend)
+{
+    suspend_on_read = suspend;
+}
+
+EvaluationContext::InputAwaiter EvaluationContext::read_input()
+{
+    return InputAwaiter(*this);
+}
+
+bool EvaluationContext::is_waiting_for_input() const
+{
+    return (bool) reader;
+}
+
+void EvaluationContext::provide_input(double value)
+{
+    provided_input = value;
+    has_provided_input = true;
+
+    /// The allocations are counted per thread and the evaluation
+    /// may be resumed by another one, so the bytes allocated before
+    /// the suspension are carried over to this thread's counter.
+    initial_bytes = Literal::allocated_bytes() - bytes_used_before_read;
+
+    task_detail::run(std::exchange(reader, {}));
+}
+
+void EvaluationContext::stop_waiting_for_input()
+{
+    reader = {};
+}
+
+const EvaluationBudget& EvaluationContext::get_budget() const
+{
+    return budget;
+}
+
+void EvaluationContext::set_budget(const EvaluationBudget& budget)
+{
+    this->budget = budget;
+}
+
+void EvaluationContext::begin_evaluation()
+{
+    steps = 0;
+    depth = 0;
+    initial_bytes = Literal::allocated_bytes();
+    max_bytes = budget.max_bytes == 0 ? std::numeric_limits<std::size_t>::max() : budget.max_bytes;
+    deadline = std::chrono::steady_clock::now() + budget.timeout;
+
+    if (budget.timeout.count() == 0)
+        next_check = budget.max_steps == 0 ? std::numeric_limits<std::uint64_t>::max() : budget.max_steps;
+    else
+        next_check = budget.max_steps == 0 ? CHECK_INTERVAL : std::min(CHECK_INTERVAL, budget.max_steps);
+}
+
+void EvaluationContext::check_budget()
+{
+    if (budget.max_steps != 0 && steps >= budget.max_steps)
+        throw budget_exceeded_exception("Evaluation :: Step limit of " + std::to_string(budget.max_steps) + " exceeded.");
+
+    if (Literal::allocated_bytes() - initial_bytes > max_bytes)
+        throw budget_exceeded_exception("Evaluation :: Memory limit of " + std::to_string(budget.max_bytes) + " bytes exceeded.");
+
+    if (budget.timeout.count() != 0 && std::chrono::steady_clock::now() >= deadline)
+        throw budget_exceeded_exception("Evaluation :: Time limit of " + std::to_string(budget.timeout.count()) + " ms exceeded.");
+
+    next_check = steps + CHECK_INTERVAL;
+    if (budget.max_steps != 0)
+        next_check = std::min(next_check, budget.max_steps);
+}
+
+void EvaluationContext::cancel()
+{
+    cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool EvaluationContext::is_cancelled() const
+{
+    return cancelled.load(std::memory_order_relaxed);
+}
+
+void EvaluationContext::throw_cancelled()
+{
+    throw evaluation_cancelled_exception();
+}
+
+void EvaluationContext::enter_call()
+{
+    check_cancelled();
+
+    if (budget.max_depth != 0 && depth >= budget.max_depth)
+        throw budget_exceeded_exception("Evaluation :: Call depth limit of " + std::to_string(budget.max_depth) + " exceeded.");
+
+    ++depth;
+    Metrics::record_depth(depth);
+}
+
+void EvaluationContext::leave_call()
+{
+    --depth;
+}
+
+EvaluationContext::InputAwaiter::InputAwaiter(EvaluationContext& context)
+        : context(context)
+{}
+
+bool EvaluationContext::InputAwaiter::await_ready() const noexcept
+{
+    return !context.suspend_on_read || context.has_provided_input;
+}
+
+void EvaluationContext::InputAwaiter::await_suspend(std::coroutine_handle<> reader) noexcept
+{
+    context.reader = reader;
+    context.flush_output();
+    context.bytes_used_before_read = Literal::allocated_bytes() - context.initial_bytes;
+}
+
+double EvaluationContext::InputAwaiter::await_resume()
+{
+    if (context.suspend_on_read) {
+        context.has_provided_input = false;
+        return context.provided_input;
+    }
+
+    /// What was written so far may be the prompt for the number.
+    context.flush_output();
+
+    double n;
+    if (!(context.get_input() >> n))
+        throw std::invalid_argument("Expression :: read() -> No number available on the input.");
+
+    return n;
+}
+
+void EvaluationContext::set_profiler(Profiler* profiler)
+{
+    this->profiler = profiler;
+}
+
+void EvaluationContext::set_tracer(Tracer* tracer)
+{
+    this->tracer = tracer;
+}
+
+EvaluationContext& EvaluationContext::standard()
+{
+    static thread_local EvaluationContext context;
+    return context;
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+#include "Literal.h"
+#include "OutputBuffer.h"
+
+class Profiler;
+class Tracer;
+
+/**
+ * @brief - Limits of a single top-level evaluation.
+ *          A limit of 0 means unlimited.
+ */
+struct EvaluationBudget {
+    /// Number of tokens and operators the evaluator may process.
+    std::uint64_t             max_steps = 0;
+
+    /// Number of bytes that may be allocated for literals.
+    std::size_t               max_bytes = 0;
+
+    /// Wall-clock time the evaluation may take.
+    std::chrono::milliseconds timeout{0};
+
+    /// Number of nested user function calls.
+    std::size_t               max_depth = 0;
+};
+
+/**
+ * @brief - How the results and write() are printed.
+ */
+enum class OUTPUT_FORMAT {
+    /// "> value" per result, the value per write().
+    TEXT,
+
+    /// A JSON object per line, see FunctionParser.
+    NDJSON
+};
+
+/**
+ * @brief - State shared by all expressions and stack frames
+ *          taking part in an evaluation:
+ *              - The stream read() takes its input from, or, when the context
+ *                suspends on read, the evaluation waiting for a number.
+ *              - The stream write() and the results are printed to, through
+ *                a buffer flushed when it is full, before read() takes its
+ *                input and when the context is destroyed, and their format.
+ *              - The budget of the current top-level evaluation
+ *                and how much of it is used.
+ *              - Whether the evaluation was cancelled.
+ */
+class EvaluationContext {
+public:
+    /**
+     * @brief - Awaited by read(). Takes the number from the input stream,
+     *          or suspends the evaluation until provide_input() when
+     *          the context suspends on read.
+     */
+    class InputAwaiter {
+        EvaluationContext& context;
+
+    public:
+        explicit InputAwaiter(EvaluationContext& context);
+
+        bool   await_ready() const noexcept;
+        void   await_suspend(std::coroutine_handle<> reader) noexcept;
+        double await_resume();
+    };
+
+private:
+    /// The clock is checked once per this many steps.
+    static constexpr std::uint64_t CHECK_INTERVAL = 1024;
+
+    std::istream* input;
+    OutputBuffer  output;
+    OUTPUT_FORMAT output_format = OUTPUT_FORMAT::TEXT;
+
+    /// The id of the request evaluated, in the records of the NDJSON output.
+    std::uint64_t request_id = 0;
+
+    bool                    suspend_on_read = false;
+    std::coroutine_handle<> reader{};
+    double                  provided_input = 0;
+    bool                    has_provided_input = false;
+    std::size_t             bytes_used_before_read = 0;
+
+    EvaluationBudget budget{};
+
+    std::uint64_t steps = 0;
+    std::uint64_t next_check = std::numeric_limits<std::uint64_t>::max();
+    std::size_t   initial_bytes = 0;
+    std::size_t   max_bytes = std::numeric_limits<std::size_t>::max();
+    std::size_t   depth = 0;
+    std::chrono::steady_clock::time_point deadline{};
+
+    std::atomic<bool> cancelled = false;
+
+    Profiler* profiler = nullptr;
+    Tracer*   tracer = nullptr;
+
+private:
+    void check_budget();
+    [[noreturn]] static void throw_cancelled();
+
+public:
+    EvaluationContext(std::istream& input = std::cin, std::ostream& output = std::cout);
+
+    EvaluationContext(const EvaluationContext&) = delete;
+    EvaluationContext& operator=(const EvaluationContext&) = delete;
+
+    std::istream& get_input();
+
+    /**
+     * @returns - The stream printed to, with the buffered output written to it,
+     *            for the text not written through get_output_buffer().
+     */
+    std::ostream& get_output();
+
+    OutputBuffer& get_output_buffer()
+    {
+        return output;
+    }
+
+    /**
+     * @brief - Writes the buffered output to the stream.
+     */
+    void flush_output();
+
+    OUTPUT_FORMAT get_output_format() const
+    {
+        return output_format;
+    }
+
+    void set_output_format(OUTPUT_FORMAT format)
+    {
+        output_format = format;
+    }
+
+    std::uint64_t get_request_id() const
+    {
+        return request_id;
+    }
+
+    void set_request_id(std::uint64_t id)
+    {
+        request_id = id;
+    }
+
+    /**
+     * @brief - When @p suspend is true, read() suspends the evaluation
+     *          instead of blocking on the input stream, so the thread
+     *          driving it is free until provide_input() is called.
+     */
+    void set_suspend_on_read(bool suspend);
+
+    /**
+     * @returns - The awaitable giving read() its number.
+     */
+    InputAwaiter read_input();
+
+    /**
+     * @returns - Whether an evaluation is suspended in read().
+     */
+    bool is_waiting_for_input() const;
+
+    /**
+     * @brief - Gives @p value to the suspended read() and resumes the
+     *          evaluation. Returns when the evaluation finishes or
+     *          suspends again. Must be called only while waiting for input,
+     *          but may be called from another thread than the one
+     *          which started the evaluation.
+     */
+    void provide_input(double value);
+
+    /**
+     * @brief - Forgets the evaluation suspended in read(),
+     *          called when it is destroyed instead of resumed.
+     */
+    void stop_waiting_for_input();
+
+    const EvaluationBudget& get_budget() const;
+    void set_budget(const EvaluationBudget& budget);
+
+    /**
+     * @brief - Starts a new top-level evaluation with the whole budget available.
+     */
+    void begin_evaluation();
+
+    /**
+     * @brief - Counts a step of the evaluator.
+     *
+     * @throws budget_exceeded_exception - If the budget is exhausted.
+     */
+    void step()
+    {
+        if (++steps >= next_check || Literal::allocated_bytes() - initial_bytes > max_bytes)
+            check_budget();
+    }
+
+    /**
+     * @brief - Asks the evaluations using this context to stop.
+     *          Can be called from any thread, the evaluations notice it
+     *          at the next call of a function. The request is not undone
+     *          by begin_evaluation().
+     */
+    void cancel();
+    bool is_cancelled() const;
+
+    /**
+     * @throws evaluation_cancelled_exception - If cancel() was called.
+     */
+    void check_cancelled() const
+    {
+        if (cancelled.load(std::memory_order_relaxed))
+            throw_cancelled();
+    }
+
+    /**
+     * @brief - Counts a user function call, every call must be
+     *          matched by leave_call() when it returns or throws.
+     *
+     * @throws budget_exceeded_exception - If the calls are nested too deep.
+     * @throws evaluation_cancelled_exception - If the evaluation was cancelled.
+     */
+    void enter_call();
+    void leave_call();
+
+    /**
+     * @brief - Sets the profiler the user function calls are reported to,
+     *          nullptr (the default) to not profile.
+     */
+    void set_profiler(Profiler* profiler);
+
+    Profiler* get_profiler() const
+    {
+        return profiler;
+    }
+
+    /**
+     * @brief - Sets the tracer the evaluations, the user function calls and
+     *          the built in function calls are recorded to, nullptr (the default)
+     *          to not trace.
+     */
+    void set_tracer(Tracer* tracer);
+
+    Tracer* get_tracer() const
+    {
+        return tracer;
+    }
+
+    /**
+     * @returns - The context used by expressions which are not given one,
+     *            reading from std::cin and printing to std::cout.
+     *            There is one such context per thread.
+     */
+    static EvaluationContext& standard();
+};
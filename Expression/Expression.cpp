@@ -1,10 +1,18 @@
 #include "Expression.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "AllocationTracker.h"
 
 #include <stdexcept>
 #include <cmath>
+#include <cstdint>
 #include <cassert>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 
-const std::unordered_map<std::string, std::tuple<int, double, Expression::mem_func_ptr>> Expression::ops {
+const std::unordered_map<std::string, Expression::operation> Expression::ops = Expression::number_operations({
         /// Operators / Function -> { Precedence : Num_Args : Function }
 
         /// Operators
@@ -29,8 +37,18 @@ const std::unordered_map<std::string, std::tuple<int, double, Expression::mem_fu
         {"list2",  std::make_tuple(0, 2, &Expression::execute_list2)},
         {"list3",  std::make_tuple(0, 3, &Expression::execute_list3)},
         {"concat", std::make_tuple(0, 2, &Expression::execute_concat)},
+        {"nth",    std::make_tuple(0, 2, &Expression::execute_nth)},
+        {"take",   std::make_tuple(0, 2, &Expression::execute_take)},
+        {"drop",   std::make_tuple(0, 2, &Expression::execute_drop)},
+        {"slice",  std::make_tuple(0, 3, &Expression::execute_slice)},
+        {"reverse", std::make_tuple(0, 1, &Expression::execute_reverse)},
+        {"sort",   std::make_tuple(0, 1, &Expression::execute_sort)},
+        {"sortBy", std::make_tuple(0, 2, nullptr)},
+        {"unique", std::make_tuple(0, 1, &Expression::execute_unique)},
+        {"indexOf", std::make_tuple(0, 2, &Expression::execute_index_of)},
+        {"binsearch", std::make_tuple(0, 2, &Expression::execute_binsearch)},
         {"if",     std::make_tuple(0, 3, nullptr)},
-        {"read",   std::make_tuple(0, 0, &Expression::execute_read)},
+        {"read",   std::make_tuple(0, 0, nullptr)},
         {"write",  std::make_tuple(0, 1, &Expression::execute_write)},
         {"int",    std::make_tuple(0, 1, &Expression::execute_int)},
 
@@ -44,7 +62,27 @@ const std::unordered_map<std::string, std::tuple<int, double, Expression::mem_fu
         /// Constants - { -1 : Value }
         {"PI",     std::make_tuple(-1, 3.14159265358979323846, nullptr)},
         {"E",      std::make_tuple(-1, 2.7182818284590452354, nullptr)},
-};
+});
+
+std::unordered_map<std::string, Expression::operation> Expression::number_operations(
+        std::initializer_list<std::pair<std::string, std::tuple<int, double, mem_func_ptr>>> operations)
+{
+    std::unordered_map<std::string, operation> result;
+    std::size_t opcode = 0;
+
+    for (const auto&[name, op] : operations) {
+        const auto&[precedence, value, func] = op;
+
+        if (precedence == -1) {
+            result.emplace(name, std::make_tuple(precedence, value, func, Metrics::MAX_BUILTINS));
+        } else {
+            Metrics::name_builtin(opcode, name);
+            result.emplace(name, std::make_tuple(precedence, value, func, opcode++));
+        }
+    }
+
+    return result;
+}
 
 const std::unordered_map<char, char> Expression::opening_bracket {
         {')', '('},
@@ -52,11 +90,15 @@ const std::unordered_map<char, char> Expression::opening_bracket {
         {'}', '{'}
 };
 
-Expression::Expression(std::string expression, SymbolTable& symbol_table, StackFrame* stack_frame)
+Expression::Expression(std::string expression,
+                       SymbolTable& symbol_table,
+                       StackFrame* stack_frame,
+                       EvaluationContext& context)
         : expression(std::move(expression)),
           len(this->expression.length()),
           stack_frame(stack_frame),
-          symbol_table(symbol_table)
+          symbol_table(symbol_table),
+          context(context)
 {
     if (this->expression.empty())
         throw std::invalid_argument(INVALID_EXPRESSION + std::string("Empty expression"));
@@ -72,20 +114,77 @@ bool Expression::is_digit(char c)
     return '0' <= c && c <= '9';
 }
 
-Literal* Expression::parse_number()
+Expression::NumberLiteral Expression::scan_number()
 {
-    std::string result{};
+    bool hexadecimal = expression[i] == '0' && (expression[i + 1] == 'x' || expression[i + 1] == 'X') &&
+                       std::isxdigit((unsigned char) expression[i + 2]);
+    if (hexadecimal)
+        i += 2;
 
-    while (i < len && is_digit(expression[i]))
-        result.push_back(expression[i++]);
+    auto is_mantissa_digit = [hexadecimal](char c) {
+        return hexadecimal ? std::isxdigit((unsigned char) c) != 0 : is_digit(c);
+    };
 
-    if (expression[i] == '.') {
-        result.push_back(expression[i++]);
-        while (i < len && is_digit(expression[i]))
-            result.push_back(expression[i++]);
+    std::size_t begin = i;
+    bool integer = true;
+
+    while (i < len && is_mantissa_digit(expression[i]))
+        ++i;
+
+    if (i < len && expression[i] == '.') {
+        integer = false;
+        ++i;
+        while (i < len && is_mantissa_digit(expression[i]))
+            ++i;
+    }
+
+    /// Only an exponent with digits, "2E" is 2 followed by the constant E.
+    if (i < len && std::tolower((unsigned char) expression[i]) == (hexadecimal ? 'p' : 'e')) {
+        std::size_t j = i + 1;
+        if (j < len && (expression[j] == '+' || expression[j] == '-'))
+            ++j;
+
+        if (j < len && is_digit(expression[j])) {
+            integer = false;
+            i = j;
+            while (i < len && is_digit(expression[i]))
+                ++i;
+        }
     }
 
-    return new Double(std::stod(result));
+    return {std::string_view(expression).substr(begin, i - begin), hexadecimal, integer};
+}
+
+double Expression::to_double(const NumberLiteral& number) const
+{
+    double value;
+    auto [end, error] = std::from_chars(number.digits.data(), number.digits.data() + number.digits.size(), value,
+                                        number.hexadecimal ? std::chars_format::hex : std::chars_format::general);
+
+    if (error != std::errc())
+        throw std::invalid_argument(INVALID_EXPRESSION + expression + "\nNumber out of range: " + std::string(number.digits));
+
+    return value;
+}
+
+std::unique_ptr<Literal> Expression::parse_number()
+{
+    NumberLiteral number = scan_number();
+
+    AllocationTracker::Site site("parse");
+
+    if (!number.integer)
+        return std::make_unique<Double>(to_double(number));
+
+    /// Integer literals are exact, of any size.
+    int base = number.hexadecimal ? 16 : 10;
+    std::int64_t value;
+    auto [end, error] = std::from_chars(number.digits.data(), number.digits.data() + number.digits.size(), value, base);
+
+    if (error == std::errc())
+        return std::make_unique<Integer>(value);
+
+    return std::make_unique<Integer>(BigInteger::parse(number.digits, base));
 }
 
 bool Expression::is_opening_bracket(char c)
@@ -99,14 +198,29 @@ bool Expression::is_closing_bracket(char c)
 }
 
 Literal* Expression::calculate()
+{
+    Task<std::unique_ptr<Literal>> task = calculate_async();
+    task.resume();
+
+    if (!task.done()) {
+        context.stop_waiting_for_input();
+        throw std::logic_error("Expression :: read() suspended a synchronous evaluation.");
+    }
+
+    return task.get().release();
+}
+
+Task<std::unique_ptr<Literal>> Expression::calculate_async()
 {
     while (i < len) {
+        context.step();
+
         while (i < len && expression[i] == ' ' || expression[i] == '\t')
             ++i;
         if (i < len && is_digit(expression[i])) { /// is number literal
             value_stack.push(parse_number());
         } else if (i < len && expression[i] == '[') { /// is list literal
-            value_stack.push(parse_list());
+            value_stack.push(co_await parse_list());
         } else if (i < len && is_opening_bracket(expression[i])) {
             op_stack.push({expression[i++]});
         } else if (i < len && is_closing_bracket(expression[i])) {
@@ -123,7 +237,10 @@ Literal* Expression::calculate()
             op_stack.pop();
 
             if (!op_stack.empty() && is_function(op_stack.top())) {
-                evaluate(op_stack.top());
+                if (is_suspending(op_stack.top()))
+                    co_await call(op_stack.top());
+                else
+                    evaluate(op_stack.top());
                 op_stack.pop();
             }
         } else if (i < len && is_letter(expression[i])) { /// is function or constant
@@ -133,7 +250,7 @@ Literal* Expression::calculate()
                 f.push_back(expression[i++]);
 
             try {
-                const auto&[precedence, value, func] = ops.at(f);
+                const auto&[precedence, value, func, opcode] = ops.at(f);
                 switch (precedence) {
 
                     case 0 : { /// is function
@@ -143,10 +260,19 @@ Literal* Expression::calculate()
                         if (f == "list")
                             determine_variadic_func(f, 1);
                         else if (f == "if") {
-                            _if();
+                            Metrics::count_builtin_call(opcode);
+                            Tracer::Scope trace(context.get_tracer(), "builtin", f);
+                            co_await _if();
                             break;
                         } else if (f == "nand") {
-                            nand();
+                            Metrics::count_builtin_call(opcode);
+                            Tracer::Scope trace(context.get_tracer(), "builtin", f);
+                            co_await nand();
+                            break;
+                        } else if (f == "sortBy") {
+                            Metrics::count_builtin_call(opcode);
+                            Tracer::Scope trace(context.get_tracer(), "builtin", f);
+                            co_await sort_by();
                             break;
                         }
 
@@ -154,7 +280,7 @@ Literal* Expression::calculate()
                         break;
                     }
                     case -1: { /// is constant
-                        value_stack.push(new Double(value));
+                        value_stack.push(std::make_unique<Double>(value));
                         break;
                     }
                     default:
@@ -184,37 +310,65 @@ Literal* Expression::calculate()
         op_stack.pop();
     }
 
-    Literal* res;
-
-    if (value_stack.top()->get_type() == LITERAL_TYPE::DOUBLE)
-        res = new Double(value_stack.top()->get_double());
-    else
-        res = new List(std::move(value_stack.top()->to_list()));
+    if (value_stack.empty())
+        throw std::invalid_argument(INVALID_EXPRESSION + expression);
 
-    delete value_stack.top();
+    std::unique_ptr<Literal> res = std::move(value_stack.top());
     value_stack.pop();
 
     if (!value_stack.empty())
         throw std::invalid_argument(INVALID_EXPRESSION + expression);
 
-    return res;
+    co_return res;
 }
 
 void Expression::evaluate(const std::string& op)
 {
+    context.step();
+    context.check_cancelled();
     get_arguments(op);
 
-    if (ops.contains(op)) {
-        (this->*std::get<2>(ops.at(op)))();
-    } else if (symbol_table.contains(op)) {
-        auto&[num_args, body] = symbol_table.at(op);
-        value_stack.push(StackFrame(body, args, symbol_table).evaluate());
-    } else {
+    auto it = ops.find(op);
+    if (it == ops.end() || !std::get<2>(it->second))
         throw std::invalid_argument(UNKNOWN_OPERATOR + expression + "\ngiven " + op);
+
+    Metrics::count_builtin_call(std::get<3>(it->second));
+
+    /// The argument separator is not a call, it would fill the trace.
+    bool comma = std::get<2>(it->second) == &Expression::execute_comma;
+    Tracer::Scope trace(comma ? nullptr : context.get_tracer(), "builtin", op, args);
+    AllocationTracker::Site site(it->first.c_str());
+    (this->*std::get<2>(it->second))();
+
+    args.clear();
+}
+
+Task<void> Expression::call(const std::string& func)
+{
+    context.step();
+    context.check_cancelled();
+    get_arguments(func);
+
+    if (func == "read") {
+        static const std::size_t READ_OPCODE = std::get<3>(ops.at("read"));
+        Metrics::count_builtin_call(READ_OPCODE);
+        double value = co_await context.read_input();
+        AllocationTracker::Site site("read");
+        value_stack.push(std::make_unique<Double>(value));
+    } else if (symbol_table.contains(func)) {
+        auto&[num_args, body] = symbol_table.at(func);
+        Profiler::Scope profile(context.get_profiler(), func);
+        value_stack.push(co_await StackFrame(body, std::move(args), symbol_table, context, func).evaluate());
+    } else {
+        throw std::invalid_argument(UNKNOWN_OPERATOR + expression + "\ngiven " + func);
     }
 
-    for (Literal* arg: args)
-        delete arg;
+    args.clear();
+}
+
+bool Expression::is_suspending(const std::string& func)
+{
+    return func == "read" || !ops.contains(func);
 }
 
 void Expression::handle_operator(std::string& op)
@@ -313,7 +467,7 @@ void Expression::get_arguments(const std::string& op)
         if (value_stack.empty())
             throw std::invalid_argument(INVALID_EXPRESSION + expression);
 
-        args[j] = value_stack.top();
+        args[j] = std::move(value_stack.top());
         value_stack.pop();
     }
 }
@@ -363,7 +517,7 @@ void Expression::determine_variadic_func(std::string& op, short min_num_args)
 
 double Expression::eq(const Literal& a, const Literal& b)
 {
-    return a == b ? 1.0 : 0.0;
+    return List::equal(a, b) ? 1.0 : 0.0;
 }
 
 double Expression::le(double a, double b)
@@ -371,27 +525,40 @@ double Expression::le(double a, double b)
     return a < b ? 1.0 : 0.0;
 }
 
-double Expression::read()
-{
-    double n;
-    std::cin >> n;
-    return n;
-}
-
-double Expression::write(Literal* a)
+double Expression::write(const Literal* a)
 {
     assert(a);
     try {
-        std::cout << *a << '\n';
+        OutputBuffer& output = context.get_output_buffer();
+
+        if (context.get_output_format() == OUTPUT_FORMAT::NDJSON) {
+            output << "{\"id\":" << (std::int64_t) context.get_request_id() << ",\"write\":";
+            output.write_json(*a);
+            output << "}\n";
+        } else {
+            output << *a << '\n';
+        }
         return 0;
     } catch (...) {
         return 1;
     }
 }
 
-Literal* Expression::parse_list()
+Task<std::unique_ptr<Literal>> Expression::parse_list()
 {
-    std::list<Literal*> lst;
+    /// The elements once one of them is not a number, until then the numbers.
+    std::vector<std::unique_ptr<Literal>> lst;
+    std::vector<double> numbers;
+
+    auto add_element = [&](std::unique_ptr<Literal> element) {
+        AllocationTracker::Site site("parse");
+        for (double number : numbers)
+            lst.push_back(std::make_unique<Double>(number));
+
+        numbers.clear();
+        lst.push_back(std::move(element));
+    };
+
     if (expression[i] == '[') {
         ++i;
         while (i < len && expression[i] != ']') {
@@ -399,15 +566,22 @@ Literal* Expression::parse_list()
                 ++i;
                 continue;
             } else if (is_digit(expression[i])) {
-                Literal* num = parse_number();
-                lst.push_back(new Double(num->get_double()));
-                delete num;
+                std::size_t begin = i;
+                NumberLiteral number = scan_number();
+                double value = to_double(number);
+
+                /// Integers a double would round are kept as Integers.
+                if (lst.empty() && !(number.integer && std::abs(value) >= 0x1p53)) {
+                    numbers.push_back(value);
+                } else {
+                    i = begin;
+                    add_element(parse_number());
+                }
             } else if (is_letter(expression[i])) {
                 std::string expr = get_argument_expr();
-                Literal* value = Expression(expr, symbol_table, stack_frame).calculate();
-                lst.push_back(value);
+                add_element(co_await Expression(expr, symbol_table, stack_frame, context).calculate_async());
             } else if (expression[i] == '[') {
-                lst.push_back(parse_list());
+                add_element(co_await parse_list());
             } else {
                 throw std::invalid_argument(INVALID_EXPRESSION + expression);
             }
@@ -419,10 +593,14 @@ Literal* Expression::parse_list()
 
     ++i;
 
-    return new List(lst);
+    AllocationTracker::Site site("parse");
+    if (lst.empty())
+        co_return std::make_unique<List>(std::move(numbers));
+
+    co_return std::make_unique<List>(std::move(lst));
 }
 
-void Expression::_if()
+Task<void> Expression::_if()
 {
     while (i < len && expression[i] == ' ')
         ++i;
@@ -431,23 +609,21 @@ void Expression::_if()
         ++i;
         std::string arg = get_argument_expr();
 
-        Literal* predicate = Expression(arg, symbol_table, stack_frame).calculate();
+        std::unique_ptr<Literal> predicate = co_await Expression(arg, symbol_table, stack_frame, context).calculate_async();
 
         std::size_t skipped;
         if (*predicate) {
             arg = get_argument_expr();
-            value_stack.push(Expression(arg, symbol_table, stack_frame).calculate());
+            value_stack.push(co_await Expression(arg, symbol_table, stack_frame, context).calculate_async());
             skipped = skip_argument_expr();
         } else {
             skipped = skip_argument_expr();
             arg = get_argument_expr();
-            value_stack.push(Expression(arg, symbol_table, stack_frame).calculate());
+            value_stack.push(co_await Expression(arg, symbol_table, stack_frame, context).calculate_async());
         }
 
         if (skipped == 0)
             throw std::invalid_argument(INVALID_EXPRESSION + expression);
-
-        delete predicate;
     }
 
     if (i >= len || expression[i] != ')')
@@ -457,7 +633,7 @@ void Expression::_if()
 }
 
 
-void Expression::nand()
+Task<void> Expression::nand()
 {
     while (i < len && expression[i] == ' ')
         ++i;
@@ -466,22 +642,23 @@ void Expression::nand()
         ++i;
         std::string arg = get_argument_expr();
 
-        Literal* arg_expr = Expression(arg, symbol_table, stack_frame).calculate();
+        std::unique_ptr<Literal> arg_expr = co_await Expression(arg, symbol_table, stack_frame, context).calculate_async();
 
+        bool result;
         if (*arg_expr) {
             arg = get_argument_expr();
-            value_stack.push(*Expression(arg, symbol_table, stack_frame).calculate()
-                             ? new Double(0.0) : new Double(1.0));
+            result = !*co_await Expression(arg, symbol_table, stack_frame, context).calculate_async();
         } else {
             std::size_t skipped = skip_argument_expr();
 
             if (skipped == 0)
                 throw std::invalid_argument(INVALID_EXPRESSION + expression);
 
-            value_stack.push(new Double(1.0));
+            result = true;
         }
 
-        delete arg_expr;
+        AllocationTracker::Site site("nand");
+        value_stack.push(std::make_unique<Double>(result ? 1.0 : 0.0));
     }
 
     if (i >= len || expression[i] != ')')
@@ -491,6 +668,89 @@ void Expression::nand()
 }
 
 
+Task<void> Expression::sort_by()
+{
+    while (i < len && expression[i] == ' ')
+        ++i;
+
+    if (i < len && expression[i] == '(') {
+        ++i;
+        std::string arg = get_argument_expr();
+
+        std::unique_ptr<Literal> list = co_await Expression(arg, symbol_table, stack_frame, context).calculate_async();
+
+        std::string comparator = get_argument_expr();
+        while (!comparator.empty() && comparator.back() == ' ')
+            comparator.pop_back();
+
+        if (SymbolTable::is_reserved(comparator) || !symbol_table.contains(comparator) ||
+            symbol_table.at(comparator).first != 2) {
+            throw std::invalid_argument("Invalid comparator of sortBy in expression: " +
+                                        expression +
+                                        "\nExpected the name of a function of two arguments, given: " + comparator);
+        }
+
+        if (list->length() == -1)
+            throw std::invalid_argument("Expression :: sortBy() -> Cannot sort an endless list.");
+
+        List elements = list->to_list();
+        Literal::elements_type sorted(elements.size());
+        for (std::size_t k = 0; k < sorted.size(); ++k)
+            sorted[k] = elements.at(k);
+
+        /// A bottom-up merge sort, which is stable and calls the comparator O(n log n) times.
+        Literal::elements_type merged(sorted.size());
+
+        for (std::size_t width = 1; width < sorted.size(); width *= 2) {
+            for (std::size_t begin = 0; begin < sorted.size(); begin += 2 * width) {
+                std::size_t middle = std::min(begin + width, sorted.size());
+                std::size_t end = std::min(begin + 2 * width, sorted.size());
+                std::size_t left = begin, right = middle, k = begin;
+
+                while (left < middle && right < end) {
+                    if (co_await is_before(comparator, *sorted[right], *sorted[left]))
+                        merged[k++] = sorted[right++];
+                    else
+                        merged[k++] = sorted[left++];
+                }
+
+                std::copy(sorted.begin() + left, sorted.begin() + middle, merged.begin() + k);
+                std::copy(sorted.begin() + right, sorted.begin() + end, merged.begin() + k + middle - left);
+            }
+
+            sorted.swap(merged);
+        }
+
+        AllocationTracker::Site site("sortBy");
+        value_stack.push(std::make_unique<List>(std::move(sorted)));
+    }
+
+    if (i >= len || expression[i] != ')')
+        throw std::invalid_argument(INVALID_BRACKETS + expression);
+
+    ++i;
+}
+
+Task<bool> Expression::is_before(const std::string& comparator, const Literal& a, const Literal& b)
+{
+    context.step();
+    context.check_cancelled();
+
+    std::vector<std::unique_ptr<Literal>> arguments;
+    for (const Literal* argument : {&a, &b}) {
+        if (argument->get_type() == LITERAL_TYPE::LIST)
+            arguments.push_back(std::make_unique<List>(argument->to_list()));
+        else
+            arguments.push_back(std::make_unique<Double>(argument->get_double()));
+    }
+
+    const std::string& body = symbol_table.at(comparator).second;
+    Profiler::Scope profile(context.get_profiler(), comparator);
+    std::unique_ptr<Literal> result = co_await StackFrame(body, std::move(arguments), symbol_table, context, comparator).evaluate();
+
+    co_return (bool) *result;
+}
+
 std::string Expression::get_argument_expr()
 {
     std::string expr;
@@ -572,64 +832,268 @@ std::size_t Expression::skip_argument_expr()
     while (i < len && expression[i] == ' ')
         ++i;
 
+    /// The arguments in the skipped expression are not used by this evaluation.
+    if (stack_frame)
+        stack_frame->skip(std::string_view(expression).substr(j, i - j));
+
     return i - j;
 }
 
+template<typename F>
+void Expression::execute_elementwise(F f, std::optional<NumericKernels::Operation> op)
+{
+    using Operation = NumericKernels::Operation;
+
+    const Literal& a = *args[0];
+    const Literal& b = *args[1];
+    bool a_list = a.get_type() == LITERAL_TYPE::LIST;
+    bool b_list = b.get_type() == LITERAL_TYPE::LIST;
+
+    if (!a_list && !b_list) {
+        value_stack.push(std::make_unique<Double>(f(a.get_double(), b.get_double())));
+        return;
+    }
+
+    std::span<const double> x = a_list ? a.get_numbers() : std::span<const double>();
+    std::span<const double> y = b_list ? b.get_numbers() : std::span<const double>();
+
+    if (a_list && b_list && (x.size() != y.size() || a.length() != b.length()))
+        throw std::invalid_argument("Expression :: Element-wise operation on lists of different lengths in expression: " +
+                                    expression);
+
+    bool a_infinite = a_list && a.length() == -1;
+    bool b_infinite = b_list && b.length() == -1;
+    double step = 1;
+
+    if (a_infinite || b_infinite) {
+        double a_step = a_infinite ? a.get_step() : 0;
+        double b_step = b_infinite ? b.get_step() : 0;
+
+        if (op == Operation::ADD)
+            step = a_step + b_step;
+        else if (op == Operation::SUB)
+            step = a_step - b_step;
+        else if (op == Operation::MUL && !(a_infinite && b_infinite))
+            step = a_infinite ? a_step * b.get_double() : a.get_double() * b_step;
+        else if (op == Operation::DIV && !b_list)
+            step = a_step / b.get_double();
+        else
+            throw std::invalid_argument("Expression :: The result is not an infinite arithmetic list in expression: " +
+                                        expression);
+    }
+
+    auto compute = [&](std::span<double> result) {
+        if (op) {
+            if (a_list && b_list)
+                NumericKernels::apply(*op, x, y, result);
+            else if (a_list)
+                NumericKernels::apply(*op, x, b.get_double(), result);
+            else
+                NumericKernels::apply(*op, a.get_double(), y, result);
+        } else {
+            for (std::size_t k = 0; k < result.size(); ++k)
+                result[k] = f(a_list ? x[k] : a.get_double(), b_list ? y[k] : b.get_double());
+        }
+    };
+
+    /// The result is written over the numbers of a list argument nothing else refers to.
+    std::size_t reused = reusable_argument(0) ? 0 : 1;
+    if (List* list = reusable_argument(reused)) {
+        compute(list->numbers_in_place(step));
+        value_stack.push(std::move(args[reused]));
+        return;
+    }
+
+    std::vector<double> result(a_list ? x.size() : y.size());
+    compute(result);
+
+    value_stack.push(std::make_unique<List>(std::move(result), step, a_infinite || b_infinite ? -1 : 0));
+}
+
+template<typename F>
+void Expression::execute_elementwise(F f,
+                                     void (*kernel)(std::span<const double>, std::span<double>),
+                                     std::optional<double> factor)
+{
+    const Literal& a = *args[0];
+
+    if (a.is_number()) {
+        value_stack.push(std::make_unique<Double>(f(a.get_double())));
+        return;
+    }
+
+    std::span<const double> x = a.get_numbers();
+    bool infinite = a.length() == -1;
+
+    if (infinite && !factor)
+        throw std::invalid_argument("Expression :: The result is not an infinite arithmetic list in expression: " +
+                                    expression);
+
+    double step = infinite ? a.get_step() * *factor : 1;
+
+    auto compute = [&](std::span<double> result) {
+        if (kernel) {
+            kernel(x, result);
+        } else {
+            for (std::size_t k = 0; k < result.size(); ++k)
+                result[k] = f(x[k]);
+        }
+    };
+
+    if (List* list = reusable_argument(0)) {
+        compute(list->numbers_in_place(step));
+        value_stack.push(std::move(args[0]));
+        return;
+    }
+
+    std::vector<double> result(x.size());
+    compute(result);
+
+    value_stack.push(std::make_unique<List>(std::move(result), step, infinite ? -1 : 0));
+}
+
+template<typename F>
+bool Expression::execute_integer(F f)
+{
+    if (args[0]->get_type() != LITERAL_TYPE::INTEGER || args[1]->get_type() != LITERAL_TYPE::INTEGER)
+        return false;
+
+    value_stack.push(std::make_unique<Integer>(f(static_cast<const Integer&>(*args[0]).get_integer(),
+                                                 static_cast<const Integer&>(*args[1]).get_integer())));
+    return true;
+}
+
+List* Expression::reusable_argument(std::size_t idx) const
+{
+    if (args[idx]->get_type() != LITERAL_TYPE::LIST)
+        return nullptr;
+
+    List* list = static_cast<List*>(args[idx].get());
+    return list->is_reusable() ? list : nullptr;
+}
+
+template<typename F>
+bool Expression::reuse_argument(F f)
+{
+    if (args[0]->get_type() != LITERAL_TYPE::LIST || !f(static_cast<List&>(*args[0])))
+        return false;
+
+    value_stack.push(std::move(args[0]));
+    return true;
+}
+
 void Expression::execute_add()
 {
-    value_stack.push(new Double(args[0]->get_double() + args[1]->get_double()));
+    if (execute_integer([](const BigInteger& a, const BigInteger& b) { return a + b; }))
+        return;
+
+    execute_elementwise([](double a, double b) { return a + b; }, NumericKernels::Operation::ADD);
 }
 
 void Expression::execute_sub()
 {
-    value_stack.push(new Double(args[0]->get_double() - args[1]->get_double()));
+    if (execute_integer([](const BigInteger& a, const BigInteger& b) { return a - b; }))
+        return;
+
+    execute_elementwise([](double a, double b) { return a - b; }, NumericKernels::Operation::SUB);
 }
 
 void Expression::execute_mul()
 {
-    value_stack.push(new Double(args[0]->get_double() * args[1]->get_double()));
+    if (execute_integer([](const BigInteger& a, const BigInteger& b) { return a * b; }))
+        return;
+
+    execute_elementwise([](double a, double b) { return a * b; }, NumericKernels::Operation::MUL);
 }
 
 void Expression::execute_div()
 {
-    value_stack.push(new Double(args[0]->get_double() / args[1]->get_double()));
+    /// Exact when the division leaves no remainder, otherwise the nearest double.
+    if (args[0]->get_type() == LITERAL_TYPE::INTEGER && args[1]->get_type() == LITERAL_TYPE::INTEGER) {
+        const BigInteger& a = static_cast<const Integer&>(*args[0]).get_integer();
+        const BigInteger& b = static_cast<const Integer&>(*args[1]).get_integer();
+
+        if (!b.is_zero() && (a % b).is_zero())
+            value_stack.push(std::make_unique<Integer>(a / b));
+        else
+            value_stack.push(std::make_unique<Double>(BigInteger::ratio(a, b)));
+        return;
+    }
+
+    execute_elementwise([](double a, double b) { return a / b; }, NumericKernels::Operation::DIV);
 }
 
 void Expression::execute_mod()
 {
-    if (!is_integer(args[0]->get_double())) {
-        throw std::invalid_argument("Invalid first argument of modulo operation in expression: " +
-                                    expression +
-                                    "\nExpected integer, actual type is double.");
-    }
+    if (execute_integer([this](const BigInteger& a, const BigInteger& b) {
+        if (b.is_zero()) {
+            throw std::invalid_argument("Invalid second argument of modulo operation in expression: " +
+                                        expression +
+                                        "\nExpected non-zero integer.");
+        }
 
-    if (!is_integer(args[1]->get_double())) {
-        throw std::invalid_argument("Invalid second argument of modulo operation in expression: " +
-                                    expression +
-                                    "\nExpected integer, actual type is double.");
+        return a % b;
+    })) {
+        return;
     }
 
-    value_stack.push(new Double((int) args[0]->get_double() % (int) args[1]->get_double()));
+    execute_elementwise([this](double a, double b) {
+        if (!is_integer(a)) {
+            throw std::invalid_argument("Invalid first argument of modulo operation in expression: " +
+                                        expression +
+                                        "\nExpected integer, actual type is double.");
+        }
+
+        if (!is_integer(b)) {
+            throw std::invalid_argument("Invalid second argument of modulo operation in expression: " +
+                                        expression +
+                                        "\nExpected integer, actual type is double.");
+        }
+
+        /// Within the tolerance of an integer, taken as that integer.
+        a = std::round(a);
+        b = std::round(b);
+
+        if (b == 0) {
+            throw std::invalid_argument("Invalid second argument of modulo operation in expression: " +
+                                        expression +
+                                        "\nExpected non-zero integer.");
+        }
+
+        /// Exact for any integral doubles, with the sign of a as for integers.
+        double remainder = std::fmod(a, b);
+        return remainder == 0 ? 0.0 : remainder;
+    });
 }
 
 void Expression::execute_sqrt()
 {
-    value_stack.push(new Double(std::sqrt(args[0]->get_double())));
+    execute_elementwise([](double a) { return std::sqrt(a); }, NumericKernels::sqrt);
 }
 
 void Expression::execute_pow()
 {
-    value_stack.push(new Double(std::pow(args[0]->get_double(), args[1]->get_double())));
+    execute_elementwise([](double a, double b) { return std::pow(a, b); });
 }
 
 void Expression::execute_unary_plus()
 {
-    value_stack.push(new Double(args[0]->get_double()));
+    if (args[0]->get_type() == LITERAL_TYPE::INTEGER) {
+        value_stack.push(std::move(args[0]));
+        return;
+    }
+
+    execute_elementwise([](double a) { return a; }, nullptr, 1.0);
 }
 
 void Expression::execute_unary_minus()
 {
-    value_stack.push(new Double((-1) * args[0]->get_double()));
+    if (args[0]->get_type() == LITERAL_TYPE::INTEGER) {
+        value_stack.push(std::make_unique<Integer>(-static_cast<const Integer&>(*args[0]).get_integer()));
+        return;
+    }
+
+    execute_elementwise([](double a) { return (-1) * a; }, nullptr, -1.0);
 }
 
 void Expression::execute_comma()
@@ -643,66 +1107,140 @@ void Expression::execute_comma()
 
 void Expression::execute_eq()
 {
-    value_stack.push(new Double(eq(args[0]->to_list(), args[1]->to_list())));
+    value_stack.push(std::make_unique<Double>(eq(*args[0], *args[1])));
 }
 
 void Expression::execute_le()
 {
-    value_stack.push(new Double(le(args[0]->get_double(), args[1]->get_double())));
+    if (args[0]->get_type() == LITERAL_TYPE::INTEGER && args[1]->get_type() == LITERAL_TYPE::INTEGER) {
+        value_stack.push(std::make_unique<Double>(static_cast<const Integer&>(*args[0]).get_integer() <
+                                                  static_cast<const Integer&>(*args[1]).get_integer() ? 1.0 : 0.0));
+        return;
+    }
+
+    execute_elementwise([this](double a, double b) { return le(a, b); }, NumericKernels::Operation::LESS);
 }
 
 void Expression::execute_length()
 {
-    value_stack.push(new Double(args[0]->length()));
+    value_stack.push(std::make_unique<Integer>(args[0]->length()));
 }
 
 void Expression::execute_head()
 {
-    const Literal* head = args[0]->head();
+    Literal::element_type head = args[0]->head();
     if (head->get_type() == LITERAL_TYPE::LIST)
-        value_stack.push(new List(head->to_list()));
+        value_stack.push(std::make_unique<List>(head->to_list()));
     else
-        value_stack.push(new Double(head->get_double()));
+        value_stack.push(make_number(*head));
 }
 
 void Expression::execute_tail()
 {
-    value_stack.push(new List(args[0]->tail()));
+    if (!reuse_argument([](List& list) { return list.tail_in_place(); }))
+        value_stack.push(std::make_unique<List>(args[0]->tail()));
 }
 
 void Expression::execute_list()
 {
-    value_stack.push(new List(args[0]->get_double()));
+    value_stack.push(std::make_unique<List>(args[0]->get_double()));
 }
 
 void Expression::execute_list2()
 {
-    value_stack.push(new List(args[0]->get_double(), (int) args[1]->get_double()));
+    value_stack.push(std::make_unique<List>(args[0]->get_double(), (int) args[1]->get_double()));
 }
 
 void Expression::execute_list3()
 {
-    value_stack.push(new List(args[0]->get_double(), args[1]->get_double(), (int) args[2]->get_double()));
+    value_stack.push(std::make_unique<List>(args[0]->get_double(), args[1]->get_double(), (int) args[2]->get_double()));
 }
 
 void Expression::execute_concat()
 {
-    value_stack.push(new List(args[0]->to_list().concat(args[1]->to_list())));
+    value_stack.push(std::make_unique<List>(args[0]->to_list().concat(args[1]->to_list())));
+}
+
+void Expression::execute_nth()
+{
+    Literal::element_type element = args[0]->to_list().nth(get_index(*args[1], "nth"));
+    if (element->get_type() == LITERAL_TYPE::LIST)
+        value_stack.push(std::make_unique<List>(element->to_list()));
+    else
+        value_stack.push(make_number(*element));
+}
+
+void Expression::execute_take()
+{
+    std::size_t n = get_index(*args[1], "take", true);
+    if (!reuse_argument([n](List& list) { return list.take_in_place(n); }))
+        value_stack.push(std::make_unique<List>(args[0]->to_list().take(n)));
+}
+
+void Expression::execute_drop()
+{
+    std::size_t n = get_index(*args[1], "drop", true);
+    if (!reuse_argument([n](List& list) { return list.drop_in_place(n); }))
+        value_stack.push(std::make_unique<List>(args[0]->to_list().drop(n)));
+}
+
+void Expression::execute_slice()
+{
+    std::size_t begin = get_index(*args[1], "slice", true);
+    std::size_t end = get_index(*args[2], "slice", true);
+    if (!reuse_argument([begin, end](List& list) { return list.slice_in_place(begin, end); }))
+        value_stack.push(std::make_unique<List>(args[0]->to_list().slice(begin, end)));
+}
+
+void Expression::execute_reverse()
+{
+    if (!reuse_argument([](List& list) { return list.reverse_in_place(); }))
+        value_stack.push(std::make_unique<List>(args[0]->to_list().reverse()));
+}
+
+void Expression::execute_sort()
+{
+    if (!reuse_argument([](List& list) { return list.sort_in_place(); }))
+        value_stack.push(std::make_unique<List>(args[0]->to_list().sort()));
+}
+
+void Expression::execute_unique()
+{
+    value_stack.push(std::make_unique<List>(args[0]->to_list().unique()));
 }
 
-void Expression::execute_read()
+void Expression::execute_index_of()
 {
-    value_stack.push(new Double(read()));
+    value_stack.push(std::make_unique<Integer>(args[0]->to_list().index_of(*args[1])));
+}
+
+void Expression::execute_binsearch()
+{
+    value_stack.push(std::make_unique<Integer>(args[0]->to_list().binary_search(args[1]->get_double())));
 }
 
 void Expression::execute_write()
 {
-    value_stack.push(new Double(write(args[0])));
+    value_stack.push(std::make_unique<Double>(write(args[0].get())));
 }
 
 void Expression::execute_int()
 {
-    value_stack.push(new Double(std::floor(args[0]->get_double())));
+    if (args[0]->get_type() == LITERAL_TYPE::INTEGER) {
+        value_stack.push(std::move(args[0]));
+        return;
+    }
+
+    if (args[0]->is_number()) {
+        /// Doubles past 64 bits stay doubles.
+        double floor = std::floor(args[0]->get_double());
+        if (std::abs(floor) < 0x1p63) {
+            value_stack.push(std::make_unique<Integer>((std::int64_t) floor));
+            return;
+        }
+    }
+
+    execute_elementwise([](double a) { return std::floor(a); }, NumericKernels::floor);
 }
 
 void Expression::get_function_parameter()
@@ -717,10 +1255,50 @@ void Expression::get_function_parameter()
         int num_arg = std::strtol(num.c_str(), nullptr, 10);
         assert(stack_frame);
 
+        AllocationTracker::Site site("argument");
         value_stack.push(stack_frame->get_argument(num_arg));
     }
 }
 
+std::size_t Expression::get_index(const Literal& literal, const std::string& function, bool clamp) const
+{
+    double index = literal.get_double();
+
+    if (!is_integer(index) || index < 0) {
+        throw std::invalid_argument("Invalid index of " + function + " in expression: " +
+                                    expression +
+                                    "\nExpected non-negative integer.");
+    }
+
+    /// Not representable, (double) SIZE_MAX is 2^64.
+    if (index >= (double) SIZE_MAX) {
+        if (clamp)
+            return SIZE_MAX;
+
+        throw std::invalid_argument("Invalid index of " + function + " in expression: " +
+                                    expression +
+                                    "\nExpected index below 2^64.");
+    }
+
+    return (std::size_t) std::round(index);
+}
+
+std::unique_ptr<Literal> Expression::make_number(double value)
+{
+    if (value == std::trunc(value) && std::abs(value) <= 0x1p53)
+        return std::make_unique<Integer>((std::int64_t) value);
+
+    return std::make_unique<Double>(value);
+}
+
+std::unique_ptr<Literal> Expression::make_number(const Literal& number)
+{
+    if (number.get_type() == LITERAL_TYPE::INTEGER)
+        return std::make_unique<Integer>(static_cast<const Integer&>(number).get_integer());
+
+    return make_number(number.get_double());
+}
+
 bool Expression::is_integer(double a)
 {
     return std::abs(a - std::floor(a)) < 0.0001;
@@ -1,18 +1,27 @@
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <stack>
 #include <unordered_map>
 #include <vector>
 
 #include "Literal.h"
+#include "NumericKernels.h"
 #include "SymbolTable.h"
 #include "StackFrame.h"
+#include "EvaluationContext.h"
+#include "Task.h"
 
 class Expression {
 
     using mem_func_ptr = void (Expression::*)();
 
+    /// Precedence, num of arguments or value, function and opcode counted in the metrics.
+    using operation = std::tuple<int, double, mem_func_ptr, std::size_t>;
+
     static inline const char* INVALID_EXPRESSION = "Expression :: Invalid expression in expression: ";
     static inline const char* UNKNOWN_OPERATOR = "Expression :: Unknown operator in expression: ";
     static inline const char* UNKNOWN_FUNCTION_OR_CONSTANT = "Expression :: Unknown function or constant in expression: ";
@@ -22,23 +31,31 @@ class Expression {
     static const std::unordered_map<char, char> opening_bracket;
 
     /// Maps each operator to its precedence and num of arguments and function.
-    static const std::unordered_map<std::string, std::tuple<int, double, mem_func_ptr>> ops;
+    static const std::unordered_map<std::string, operation> ops;
 
 
     SymbolTable& symbol_table;
     StackFrame* stack_frame;
+    EvaluationContext& context;
 
     std::string expression;     /// The expression.
     std::size_t i = 0;          /// Position in the expression.
     std::size_t len = 0;        /// Length of the expression.
 
-    std::stack<Literal*> value_stack{};
+    std::stack<std::unique_ptr<Literal>> value_stack{};
     std::stack<std::string> op_stack{};
 
-    std::vector<Literal*> args{};
+    std::vector<std::unique_ptr<Literal>> args{};
 
 private:
 
+    /**
+     * @brief Gives the operators their opcodes, in order, and names them in the metrics.
+     *        Constants get no opcode.
+     */
+    static std::unordered_map<std::string, operation> number_operations(
+            std::initializer_list<std::pair<std::string, std::tuple<int, double, mem_func_ptr>>> operations);
+
     /**
      * Utility functions checking if the argument is valid.
      */
@@ -55,22 +72,82 @@ private:
     void determine_variadic_func(std::string& op, short min_num_args);
     static bool is_integer(double a);
 
+    /**
+     * @returns - A number of a list, which are stored as doubles,
+     *            as an Integer when it is an integer exactly.
+     */
+    static std::unique_ptr<Literal> make_number(double value);
+
+    /**
+     * @returns - A number taken out of a list, a copy of it if it is an Integer.
+     */
+    static std::unique_ptr<Literal> make_number(const Literal& number);
+
+    /**
+     * @returns The value of @p literal as an index of a list, the argument of @p function.
+     *          With @p clamp an index from 2^64 on is SIZE_MAX, past the end of any list.
+     *
+     * @throws std::invalid_argument - If it is not a non-negative integer,
+     *                                 or without @p clamp if it is from 2^64 on.
+     */
+    std::size_t get_index(const Literal& literal, const std::string& function, bool clamp = false) const;
+
+    /**
+     * @brief A number literal, which refers to the expression instead of copying it.
+     */
+    struct NumberLiteral {
+        std::string_view digits;    /// Without the "0x" of a hexadecimal number.
+        bool hexadecimal;
+        bool integer;               /// Whether it has no fraction and no exponent.
+    };
+
+    /**
+     * @brief Finds the end of the number literal at the current position,
+     *        in decimal with an optional fraction and exponent ("1.5e-3"), or
+     *        in hexadecimal after "0x" with an optional fraction and binary
+     *        exponent ("0x1.8p3"), the forms std::from_chars reads.
+     */
+    NumberLiteral scan_number();
+
+    /**
+     * @returns The value of @p number as a double, the way the numbers of lists are stored.
+     *
+     * @throws std::invalid_argument - If it is too large or too small for a double.
+     */
+    double to_double(const NumberLiteral& number) const;
+
     /**
      * @brief Parses the numbers in the expression
      *
-     * @returns the current number
+     * @returns the current number, an Integer for an integer literal
+     */
+    std::unique_ptr<Literal> parse_number();
+
+    /**
+     * @brief Parses a list literal, whose numbers are read straight
+     *        into the array of the list while they are all numbers.
      */
-    Literal* parse_number();
-    Literal* parse_list();
+    Task<std::unique_ptr<Literal>> parse_list();
 
     /**
      * @brief Takes an operator, then takes the arguments from
      *        the @p value_stack and evaluates the expression.
      *        In the end it pushes the new value on the @p value_stack.
-     * @param op - The operator to be applied.
+     * @param op - The operator to be applied, a built in one which does not suspend.
      */
     void evaluate(const std::string& func);
 
+    /**
+     * @brief Same as evaluate(), but for the functions which may
+     *        suspend the evaluation: the user defined ones and read().
+     */
+    Task<void> call(const std::string& func);
+
+    /**
+     * @returns - Whether @p func has to be evaluated with call().
+     */
+    static bool is_suspending(const std::string& func);
+
     /**
      * @brief Takes the next operator, pops previous ones off the
      *        @p op_stack and pushes the new op.
@@ -82,14 +159,61 @@ private:
     /// Built in functions
     double eq(const Literal& a, const Literal& b);
     double le(double a, double b);
-    double read();
-    double write(Literal* a);
-    void _if();
-    void nand();
+    double write(const Literal* a);
+    Task<void> _if();
+    Task<void> nand();
+    Task<void> sort_by();
+
+    /**
+     * @returns Whether the user defined function @p comparator called with @p a and @p b is true.
+     */
+    Task<bool> is_before(const std::string& comparator, const Literal& a, const Literal& b);
 
     std::string get_argument_expr();
     std::size_t skip_argument_expr();
 
+    /**
+     * @brief Pushes @p f applied to the two arguments, element-wise when they are
+     *        lists of numbers of the same length or a list of numbers and a number.
+     *        The lists are processed by @p op, when given.
+     *        Infinite lists are supported when the result is an arithmetic list,
+     *        which takes adding, subtracting, multiplying or dividing by a number.
+     */
+    template<typename F>
+    void execute_elementwise(F f, std::optional<NumericKernels::Operation> op = {});
+
+    /**
+     * @brief Pushes @p f applied to the two arguments, when they are integers.
+     *
+     * @returns - Whether it was pushed.
+     */
+    template<typename F>
+    bool execute_integer(F f);
+
+    /**
+     * @returns - The argument at @p idx if it is a list which can be modified
+     *            in place, see List::is_reusable(), nullptr otherwise.
+     */
+    List* reusable_argument(std::size_t idx) const;
+
+    /**
+     * @brief Pushes the first argument if it is a list which @p f modified in place.
+     *
+     * @returns - Whether it was pushed.
+     */
+    template<typename F>
+    bool reuse_argument(F f);
+
+    /**
+     * @brief Pushes @p f applied to the argument, element-wise when it is a list of numbers,
+     *        processed by @p kernel, when given.
+     *        Infinite lists are supported when @p f multiplies by @p factor.
+     */
+    template<typename F>
+    void execute_elementwise(F f,
+                             void (*kernel)(std::span<const double>, std::span<double>),
+                             std::optional<double> factor = {});
+
     void execute_add();
     void execute_sub();
     void execute_mul();
@@ -109,7 +233,15 @@ private:
     void execute_list2();
     void execute_list3();
     void execute_concat();
-    void execute_read();
+    void execute_nth();
+    void execute_take();
+    void execute_drop();
+    void execute_slice();
+    void execute_reverse();
+    void execute_sort();
+    void execute_unique();
+    void execute_index_of();
+    void execute_binsearch();
     void execute_write();
     void execute_int();
 
@@ -117,12 +249,26 @@ private:
     void get_function_parameter();
 
 public:
-    Expression(std::string expression, SymbolTable& symbol_table, StackFrame* stack_frame = nullptr);
+    Expression(std::string expression,
+               SymbolTable& symbol_table,
+               StackFrame* stack_frame = nullptr,
+               EvaluationContext& context = EvaluationContext::standard());
 
     /**
      * @brief Calculates the expression.
      *
-     * @returns The value of the expression
+     * @returns The value of the expression, owned by the caller.
+     *
+     * @throws std::logic_error - If the context suspends on read and the expression calls read().
      */
     Literal* calculate();
+
+    /**
+     * @brief Calculates the expression as a coroutine, which suspends
+     *        in read() when the context suspends on read.
+     *        The expression must outlive the returned task.
+     *
+     * @returns The value of the expression
+     */
+    Task<std::unique_ptr<Literal>> calculate_async();
 };
\ No newline at end of file
@@ -1,12 +1,31 @@
 #include "FunctionParser.h"
 
+#include <chrono>
 #include <stack>
 #include <set>
 
+#include "Tracer.h"
+#include "AllocationTracker.h"
+
 std::istream& operator>>(std::istream& is, FunctionParser& fp)
+{
+    Task<void> task = fp.handle(is);
+    task.resume();
+
+    if (!task.done()) {
+        fp.context.stop_waiting_for_input();
+        throw std::logic_error("FunctionParser :: read() suspended a synchronous evaluation.");
+    }
+
+    task.get();
+    return is;
+}
+
+Task<void> FunctionParser::handle(std::istream& is)
 {
     std::string line;
     std::getline(is, line);
+    std::uint64_t id = ++lines_read;
 
     if (FunctionParser::should_exit(line))
         throw exit_exception("> Goodbye! :)");
@@ -14,11 +33,42 @@ std::istream& operator>>(std::istream& is, FunctionParser& fp)
     std::size_t i = 0;
 
     if (FunctionParser::is_blanc(line, i))
-        return is;
+        co_return;
 
     if (line.length() > 1 && line[0] == '/' && line[1] == '/')
-        return is;
+        co_return;
+
+    if (line[i] == ':') {
+        run_command(line, i + 1);
+        co_return;
+    }
+
+    if (context.get_output_format() == OUTPUT_FORMAT::TEXT) {
+        co_await handle_request(is, line, i);
+        co_return;
+    }
 
+    /// Errors are reported by the record of the request.
+    context.set_request_id(id);
+    request_start = std::chrono::steady_clock::now();
+
+    std::string error;
+    try {
+        co_await handle_request(is, line, i);
+        co_return;
+    } catch (std::exception& e) {
+        error = e.what();
+    }
+
+    OutputBuffer& output = context.get_output_buffer();
+    output << "{\"id\":" << (std::int64_t) id << ",\"error\":";
+    output.write_json(error);
+    write_elapsed_time();
+    output << "}\n";
+}
+
+Task<void> FunctionParser::handle_request(std::istream& is, std::string& line, std::size_t i)
+{
     std::string expression;
     std::string function_name;
 
@@ -47,7 +97,9 @@ std::istream& operator>>(std::istream& is, FunctionParser& fp)
 
         while (!brackets.empty() || expression.empty()) {
             if (i >= size) {
-                std::getline(is, line);
+                if (!std::getline(is, line))
+                    throw std::invalid_argument(FunctionParser::INVALID_FUNCTION_DEFINITION + expression);
+                ++lines_read;
                 size = line.length();
                 i = 0;
             }
@@ -78,28 +130,94 @@ std::istream& operator>>(std::istream& is, FunctionParser& fp)
             }
         }
 
-        if (!fp.symbol_table.contains(function_name))
-            std::cout << "> 0\n";
-        else
-            std::cout << "> 1\n";
-
-        fp.symbol_table.add_definition(function_name, std::make_pair(parameters.size(), expression));
+        print_definition(function_name, symbol_table.contains(function_name));
+        symbol_table.add_definition(function_name, std::make_pair(parameters.size(), expression));
     } else {
         for (char c : line)
             expression.push_back(c);
 
-        Literal* result = Expression(expression, fp.symbol_table).calculate();
-        std::cout << "> " << *result << '\n';
-        delete result;
-    }
+        context.begin_evaluation();
+        Metrics::EvaluationTimer timer;
+        Tracer::Scope trace(context.get_tracer(), "eval", expression);
+        AllocationTracker::Evaluation allocations;
+        std::unique_ptr<Literal> result = co_await Expression(expression, symbol_table, nullptr, context).calculate_async();
+        timer.succeed();
+        print_result(*result);
+        result.reset();
 
-    return is;
+        AllocationTracker::EvaluationReport report = allocations.finish();
+        if (!report.leaks.empty()) {
+            std::cerr << "! Literals leaked by " << expression << ":\n";
+            AllocationTracker::write_report(std::cerr, report.leaks);
+        }
+    }
 }
 
-FunctionParser::FunctionParser(SymbolTable& symbol_table)
-    : symbol_table(symbol_table)
+FunctionParser::FunctionParser(SymbolTable& symbol_table, EvaluationContext& context)
+    : symbol_table(symbol_table),
+      context(context)
 {}
 
+void FunctionParser::print_result(const Literal& result)
+{
+    OutputBuffer& output = context.get_output_buffer();
+
+    if (context.get_output_format() == OUTPUT_FORMAT::TEXT) {
+        output << "> " << result << '\n';
+        return;
+    }
+
+    output << "{\"id\":" << (std::int64_t) context.get_request_id() << ",\"value\":";
+    output.write_json(result);
+    write_elapsed_time();
+    output << "}\n";
+}
+
+void FunctionParser::print_definition(const std::string& name, bool redefined)
+{
+    OutputBuffer& output = context.get_output_buffer();
+
+    if (context.get_output_format() == OUTPUT_FORMAT::TEXT) {
+        output << (redefined ? "> 1\n" : "> 0\n");
+        return;
+    }
+
+    output << "{\"id\":" << (std::int64_t) context.get_request_id() << ",\"defined\":";
+    output.write_json(name);
+    output << ",\"redefined\":" << (redefined ? "true" : "false") << "}\n";
+}
+
+void FunctionParser::write_elapsed_time()
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - request_start);
+    context.get_output_buffer() << ",\"elapsed_us\":" << (std::int64_t) elapsed.count();
+}
+
+void FunctionParser::run_command(const std::string& line, std::size_t i)
+{
+    std::string command;
+    while (i < line.length() && FunctionParser::letter(line[i]))
+        command.push_back(line[i++]);
+
+    if (!FunctionParser::is_blanc(line, i))
+        throw std::invalid_argument(FunctionParser::UNKNOWN_COMMAND + line);
+
+    if (command == "stats") {
+        Metrics::write_table(context.get_output());
+        if (AllocationTracker::enabled) {
+            context.get_output() << "live literals:\n";
+            AllocationTracker::write_report(context.get_output(), AllocationTracker::live_by_site());
+        }
+    } else if (command == "trace") {
+        if (!context.get_tracer())
+            throw std::invalid_argument("FunctionParser :: Tracing is not enabled.");
+
+        context.get_tracer()->write_json(context.get_output());
+    } else {
+        throw std::invalid_argument(FunctionParser::UNKNOWN_COMMAND + line);
+    }
+}
+
 bool FunctionParser::is_function_definition(const std::string& line)
 {
     std::size_t size = line.length();
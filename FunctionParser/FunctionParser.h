@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <string>
 
@@ -10,15 +12,32 @@
 /**
  * @brief - Handles the users input and parses the function definitions
  *          and loads the im the symbol table
+ *
+ *          With the NDJSON output format of the context every request prints
+ *          one JSON object on a line, with "id" the number of its first line:
+ *              - {"id":3,"value":[1,[2,3]],"elapsed_us":12} for a result,
+ *              - {"id":3,"error":"...","elapsed_us":12} for an error,
+ *              - {"id":1,"defined":"f","redefined":false} for a definition,
+ *              - {"id":3,"write":5} for every write() of the evaluation.
+ *          An infinite list is written as {"infinite":true,"step":1,"first":[1,2,...]}
+ *          with the elements generated so far.
+ *          The commands still print text.
  */
 class FunctionParser {
 
     static inline const char* INVALID_FUNCTION_DEFINITION = "Invalid function definition in line:\n";
     static inline const char* INVALID_PARAMETER = "Invalid parameter in line:\n";
+    static inline const char* UNKNOWN_COMMAND = "Unknown command in line:\n";
     static inline const char* EXIT_COMMAND = "exit";
     static inline int EXIT_COMMAND_LENGTH = 4;
 
     SymbolTable& symbol_table;
+    EvaluationContext& context;
+
+    /// The number of lines read, the id of a request is the number of its first line.
+    std::uint64_t lines_read = 0;
+    std::chrono::steady_clock::time_point request_start{};
+
 private:
     static bool is_valid_name_letter(char c);
     static bool letter(char c);
@@ -28,8 +47,38 @@ private:
     static bool is_blanc(const std::string& line, std::size_t& i);
     static bool should_exit(const std::string& line);
 
+    /**
+     * @brief Runs an interpreter command, a line beginning with ':'
+     *          - :stats - Prints the metrics of the interpreter.
+     *          - :trace - Prints the recorded trace as Chrome trace event JSON.
+     */
+    void run_command(const std::string& line, std::size_t i);
+
+    /**
+     * @brief - Loads the definition or evaluates the expression
+     *          beginning at @p i of @p line.
+     */
+    Task<void> handle_request(std::istream& is, std::string& line, std::size_t i);
+
+    void print_result(const Literal& result);
+    void print_definition(const std::string& name, bool redefined);
+    void write_elapsed_time();
+
 public:
-    FunctionParser(SymbolTable& symbol_table);
+    /**
+     * @param symbol_table - The table the definitions are loaded in.
+     * @param context - The context of the evaluations, the results are printed to its output.
+     */
+    FunctionParser(SymbolTable& symbol_table, EvaluationContext& context = EvaluationContext::standard());
+
+    /**
+     * @brief Reads a function definition or an expression from @p is
+     *        and loads or evaluates it. Suspends in read() when the
+     *        context suspends on read.
+     *
+     * @param is - Must outlive the returned task.
+     */
+    Task<void> handle(std::istream& is);
 
 
     friend std::istream& operator>>(std::istream& is, FunctionParser& fp);
@@ -0,0 +1,167 @@
+#include "HashCons.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "BigInteger.h"
+
+namespace {
+
+struct State {
+    std::mutex mutex;
+    std::unordered_map<std::uint64_t, std::weak_ptr<const Literal>> numbers;
+    std::map<BigInteger, std::weak_ptr<const Literal>> integers;    /// Those a double cannot hold.
+    std::unordered_multimap<std::size_t, std::weak_ptr<const void>> nodes;
+
+    /// The size of the table at which the expired entries are removed.
+    std::size_t sweep_at = 1024;
+};
+
+/**
+ * @brief - Intentionally never destroyed, lists may be freed after main().
+ */
+State& state()
+{
+    static State* instance = new State();
+    return *instance;
+}
+
+std::atomic<bool> enabled{false};
+
+std::size_t combine(std::size_t seed, std::size_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+}
+
+void HashCons::set_enabled(bool value)
+{
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+bool HashCons::is_enabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const HashCons::Node> HashCons::intern(std::shared_ptr<Node> node)
+{
+    std::lock_guard lock(state().mutex);
+    return intern_node(std::move(node));
+}
+
+Literal::element_type HashCons::intern_element(const Literal::element_type& element)
+{
+    State& s = state();
+
+    if (element->get_type() == LITERAL_TYPE::DOUBLE) {
+        std::weak_ptr<const Literal>& slot = s.numbers[std::bit_cast<std::uint64_t>(element->get_double())];
+        if (Literal::element_type existing = slot.lock())
+            return existing;
+
+        slot = element;
+        return element;
+    }
+
+    if (element->get_type() == LITERAL_TYPE::INTEGER) {
+        std::weak_ptr<const Literal>& slot = s.integers[static_cast<const Integer&>(*element).get_integer()];
+        if (Literal::element_type existing = slot.lock())
+            return existing;
+
+        slot = element;
+        return element;
+    }
+
+    const List& list = static_cast<const List&>(*element);
+    if (list.node->canonical)
+        return element;
+
+    const std::shared_ptr<const Node>& node = list.node;
+    return std::make_shared<const List>(List(intern_node(
+            std::make_shared<Node>(node, 0, node->size(), node->max_size))));
+}
+
+std::shared_ptr<const HashCons::Node> HashCons::intern_node(std::shared_ptr<Node> node)
+{
+    State& s = state();
+
+    /// The elements are interned first, so equal elements are the same
+    /// pointers and the nodes can be compared and hashed shallowly.
+    auto key = [](const Literal::element_type& element) -> const void* {
+        if (element->get_type() != LITERAL_TYPE::LIST)
+            return element.get();
+        return static_cast<const List&>(*element).node.get();
+    };
+
+    std::size_t hash = combine(std::bit_cast<std::uint64_t>(node->step), (std::size_t) node->max_size);
+    hash = combine(hash, node->is_numeric());
+
+    for (double number : node->numbers())
+        hash = combine(hash, std::bit_cast<std::uint64_t>(number));
+
+    /// The elements may be shared with other lists, so the interned ones are copied.
+    Literal::elements_type elements;
+    elements.reserve(node->elements().size());
+
+    for (const Literal::element_type& element : node->elements()) {
+        elements.push_back(intern_element(element));
+        hash = combine(hash, std::hash<const void*>{}(key(elements.back())));
+    }
+
+    auto [begin, end] = s.nodes.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        auto existing = std::static_pointer_cast<const Node>(it->second.lock());
+        if (!existing
+            || std::bit_cast<std::uint64_t>(existing->step) != std::bit_cast<std::uint64_t>(node->step)
+            || existing->max_size != node->max_size
+            || existing->numbers().size() != node->numbers().size()
+            || existing->elements().size() != node->elements().size())
+            continue;
+
+        bool equal = true;
+        for (std::size_t i = 0; equal && i < node->numbers().size(); ++i)
+            equal = std::bit_cast<std::uint64_t>(existing->numbers()[i]) == std::bit_cast<std::uint64_t>(node->numbers()[i]);
+
+        for (std::size_t i = 0; equal && i < elements.size(); ++i)
+            equal = key(existing->elements()[i]) == key(elements[i]);
+
+        if (equal)
+            return existing;
+    }
+
+    if (!elements.empty())
+        node = std::make_shared<Node>(std::vector<double>{}, std::move(elements), node->step, node->max_size);
+
+    node->canonical = true;
+    s.nodes.emplace(hash, std::shared_ptr<const void>(node));
+
+    if (s.numbers.size() + s.integers.size() + s.nodes.size() >= s.sweep_at)
+        sweep();
+
+    return node;
+}
+
+void HashCons::sweep()
+{
+    State& s = state();
+
+    std::erase_if(s.numbers, [](const auto& entry) { return entry.second.expired(); });
+    std::erase_if(s.integers, [](const auto& entry) { return entry.second.expired(); });
+    std::erase_if(s.nodes, [](const auto& entry) { return entry.second.expired(); });
+
+    s.sweep_at = std::max<std::size_t>(1024, 2 * (s.numbers.size() + s.integers.size() + s.nodes.size()));
+}
+
+std::size_t HashCons::size()
+{
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+
+    sweep();
+    return s.numbers.size() + s.integers.size() + s.nodes.size();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "Literal.h"
+
+/**
+ * @brief - Optional table of the lists built by the interpreter, keeping
+ *          one node per structure, so equal lists share their node and
+ *          equal numbers in lists which are not only of numbers, doubles or
+ *          integers past 2^53, share one literal.
+ *
+ *          Disabled by default. Once enabled, comparing two equal lists
+ *          is a pointer comparison and repeated values are stored once.
+ *          The table only refers to the nodes weakly, the nodes are freed
+ *          with the last list using them.
+ */
+class HashCons {
+    using Node = List::Node;
+
+    static std::shared_ptr<const Node> intern_node(std::shared_ptr<Node> node);
+    static Literal::element_type intern_element(const Literal::element_type& element);
+    static void sweep();
+
+public:
+    static void set_enabled(bool enabled);
+    static bool is_enabled();
+
+    /**
+     * @returns - The node equal to @p node in the table, after adding @p node if there is none.
+     */
+    static std::shared_ptr<const Node> intern(std::shared_ptr<Node> node);
+
+    /**
+     * @returns - The number of numbers, integers and nodes in the table.
+     */
+    static std::size_t size();
+};
@@ -1,15 +1,32 @@
 #include "Interpreter.h"
 
 #include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+#include "Server.h"
 
 Interpreter::Interpreter(char** paths, int num_of_paths)
 {
+    load(paths, num_of_paths);
+}
+
+void Interpreter::load(char** paths, int num_of_paths)
+{
+    std::ostringstream discarded;
+    EvaluationContext quiet(std::cin, discarded);
+    quiet.set_budget(context.get_budget());
+
+    bool text = context.get_output_format() == OUTPUT_FORMAT::TEXT;
+    FunctionParser loader(global_symbol_table, text ? context : quiet);
+
     for (int i = 0; i < num_of_paths; ++i) {
         std::ifstream ifs(paths[i]);
 
         while (!ifs.eof()) {
             try {
-                ifs >> function_interpreter;
+                ifs >> loader;
             } catch (std::exception& e) {
                 std::cerr << e.what() << '\n';
             }
@@ -17,16 +34,61 @@ Interpreter::Interpreter(char** paths, int num_of_paths)
     }
 }
 
+void Interpreter::set_budget(const EvaluationBudget& budget)
+{
+    context.set_budget(budget);
+}
+
+void Interpreter::set_profiler(Profiler* profiler)
+{
+    context.set_profiler(profiler);
+}
+
+void Interpreter::set_tracer(Tracer* tracer)
+{
+    context.set_tracer(tracer);
+}
+
+void Interpreter::set_precision(int precision)
+{
+    context.get_output_buffer().set_precision(precision);
+}
+
+void Interpreter::set_output_format(OUTPUT_FORMAT format)
+{
+    context.set_output_format(format);
+}
+
 void Interpreter::run()
 {
-    while (true) {
+    /// The results are shown as soon as they are printed to a terminal,
+    /// otherwise they are written in blocks.
+    bool interactive = isatty(STDIN_FILENO);
+
+    while (!std::cin.eof()) {
         try {
+            if (interactive)
+                context.flush_output();
             std::cin >> function_interpreter;
         } catch (exit_exception& e) {
-            std::cout << e.what() << '\n';
+            if (context.get_output_format() == OUTPUT_FORMAT::TEXT)
+                context.get_output() << e.what() << '\n';
+            context.flush_output();
             return;
         } catch (std::exception& e) {
+            context.flush_output();
             std::cerr << e.what() << '\n';
         }
     }
+    context.flush_output();
+}
+
+void Interpreter::serve(const std::string& socket_path, std::size_t num_threads)
+{
+    Server server(global_symbol_table, socket_path, num_threads, context.get_budget());
+    server.set_tracer(context.get_tracer());
+    server.set_precision(context.get_output_buffer().get_precision());
+
+    std::cout << "> Listening on " << socket_path << '\n';
+    server.run();
 }
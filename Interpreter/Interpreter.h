@@ -11,7 +11,8 @@
 class Interpreter {
 
     SymbolTable global_symbol_table{};
-    FunctionParser function_interpreter{global_symbol_table};
+    EvaluationContext context{};
+    FunctionParser function_interpreter{global_symbol_table, context};
 
 public:
 
@@ -25,6 +26,13 @@ public:
      */
     Interpreter(char** paths, int num_of_paths);
 
+    /**
+     * @brief - Loads definitions from files, like the constructor.
+     *          With the NDJSON output nothing is printed for them,
+     *          the records are only for the requests of the standard input.
+     */
+    void load(char** paths, int num_of_paths);
+
     Interpreter(const Interpreter&) = delete;
     Interpreter(Interpreter&&) = delete;
     Interpreter& operator=(const Interpreter&) = delete;
@@ -33,9 +41,49 @@ public:
     ~Interpreter() = default;
 
     /**
-     * @brief Runs the interpreter.
+     * @brief Sets the limits of every evaluation started from now on,
+     *        both in the interpreter and in the server's sessions.
+     */
+    void set_budget(const EvaluationBudget& budget);
+
+    /**
+     * @brief Reports the user function calls of the evaluations
+     *        to @p profiler, nullptr to stop profiling.
+     */
+    void set_profiler(Profiler* profiler);
+
+    /**
+     * @brief Records the evaluations, both in the interpreter and in the
+     *        server's sessions, to @p tracer, nullptr to stop tracing.
+     */
+    void set_tracer(Tracer* tracer);
+
+    /**
+     * @brief Prints the numbers with @p precision significant digits,
+     *        0 for the shortest representation reading back as the same number.
+     *
+     * @throws std::invalid_argument - If @p precision is above OutputBuffer::MAX_PRECISION.
+     */
+    void set_precision(int precision);
+
+    /**
+     * @brief Prints the results as text or as NDJSON records, see FunctionParser.
+     */
+    void set_output_format(OUTPUT_FORMAT format);
+
+    /**
+     * @brief Runs the interpreter until "exit" or the end of the input.
      */
     void run();
+
+    /**
+     * @brief Serves the clients connecting to @p socket_path,
+     *        sharing the loaded definitions between them.
+     *
+     * @param socket_path - The path of the Unix domain socket.
+     * @param num_threads - The number of threads evaluating the requests.
+     */
+    void serve(const std::string& socket_path, std::size_t num_threads);
 };
 
 
@@ -1,26 +1,56 @@
 #include "Literal.h"
+#include "HashCons.h"
+#include "NumericKernels.h"
+#include "OutputBuffer.h"
 
 #include <stdexcept>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+std::size_t combine(std::size_t seed, std::size_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+/// The shape of a number, and of a list equal to a number.
+constexpr std::size_t SCALAR_SHAPE = 1;
+
+}
+
+///------------------LITERAL--------------------------
+
+Literal::~Literal()
+{
+    Metrics::count_literal_freed();
+    AllocationTracker::on_free(this);
+}
 
 ///------------------DOUBLE--------------------------
 
 
 Double::Double(double value)
         : value(value)
-{}
+{
+    count_allocation(sizeof(Double));
+}
 
 double Double::get_double() const
 {
     return value;
 }
 
-const Literal::list_type& Double::get_list() const
+std::span<const double> Double::get_numbers() const
 {
-    throw std::invalid_argument("Literal :: get_list() -> Incorrect type, actual type is Double.");
+    throw std::invalid_argument("Literal :: get_numbers() -> Incorrect type, actual type is Double.");
 }
 
-const Literal* Double::head() const
+Literal::element_type Double::head() const
 {
     throw std::invalid_argument("Literal :: head() -> Incorrect type, actual type is Double.");
 }
@@ -40,11 +70,6 @@ double Double::get_step() const
     throw std::invalid_argument("Literal ::  get_step() -> Incorrect type, actual type is Double.");
 }
 
-void Double::print(std::ostream& os) const
-{
-    os << value;
-}
-
 List Double::to_list() const
 {
     return {value, 0, 1};
@@ -67,10 +92,14 @@ LITERAL_TYPE Double::get_type() const
 
 bool Double::operator==(const Literal& other) const
 {
-    if (other.get_type() == LITERAL_TYPE::DOUBLE)
+    /// Compared exactly, with the integers a double cannot hold.
+    if (other.get_type() == LITERAL_TYPE::INTEGER && !static_cast<const Integer&>(other).is_exact_double())
+        return other.operator==(*this);
+
+    if (other.is_number())
         return std::abs(value - other.get_double()) < 0.00001;
     else
-        return other.length() == 1 && value == other.head()->get_double();
+        return other.length() == 1 && value == static_cast<const List&>(other).number_at(0);
 }
 
 bool Double::operator!=(const Literal& other) const
@@ -83,57 +112,507 @@ Double::operator bool() const
     return std::abs(value) >= 0.00001;
 }
 
+///------------------INTEGER--------------------------
+
+
+Integer::Integer(BigInteger value)
+        : value(std::move(value))
+{
+    count_allocation(sizeof(Integer) + this->value.size() * sizeof(BigInteger::limb));
+}
+
+const BigInteger& Integer::get_integer() const
+{
+    return value;
+}
+
+bool Integer::is_exact_double() const
+{
+    if (!value.is_small())
+        return false;
+
+    double d = (double) value.get_small();
+    return std::abs(d) < 0x1p63 && (std::int64_t) d == value.get_small();
+}
+
+double Integer::get_double() const
+{
+    return value.to_double();
+}
+
+std::span<const double> Integer::get_numbers() const
+{
+    throw std::invalid_argument("Literal :: get_numbers() -> Incorrect type, actual type is Integer.");
+}
+
+Literal::element_type Integer::head() const
+{
+    throw std::invalid_argument("Literal :: head() -> Incorrect type, actual type is Integer.");
+}
+
+List Integer::tail() const
+{
+    throw std::invalid_argument("Literal :: tail() -> Incorrect type, actual type is Integer.");
+}
+
+int Integer::length() const
+{
+    throw std::invalid_argument("Literal :: length() -> Incorrect type, actual type is Integer.");
+}
+
+double Integer::get_step() const
+{
+    throw std::invalid_argument("Literal ::  get_step() -> Incorrect type, actual type is Integer.");
+}
+
+List Integer::to_list() const
+{
+    return {value.to_double(), 0, 1};
+}
+
+List Integer::concat(const List& other) const
+{
+    throw std::invalid_argument("Literal :: concat() -> Incorrect type, actual type is Integer.");
+}
+
+double Integer::to_double() const
+{
+    return value.to_double();
+}
+
+LITERAL_TYPE Integer::get_type() const
+{
+    return LITERAL_TYPE::INTEGER;
+}
+
+bool Integer::operator==(const Literal& other) const
+{
+    /// Compared exactly with the doubles, if a double cannot hold the value.
+    auto equals = [this](double number) {
+        return std::isfinite(number) && number == std::trunc(number) && value == BigInteger::from_double(number);
+    };
+
+    if (other.get_type() == LITERAL_TYPE::INTEGER)
+        return value == static_cast<const Integer&>(other).value;
+    else if (other.get_type() == LITERAL_TYPE::DOUBLE && is_exact_double())
+        return other.operator==(*this);
+    else if (other.get_type() == LITERAL_TYPE::DOUBLE)
+        return equals(other.get_double());
+    else if (other.length() != 1)
+        return false;
+    else if (is_exact_double())
+        return value.to_double() == static_cast<const List&>(other).number_at(0);
+    else
+        return equals(static_cast<const List&>(other).number_at(0));
+}
+
+bool Integer::operator!=(const Literal& other) const
+{
+    return !(*this == other);
+}
+
+Integer::operator bool() const
+{
+    return !value.is_zero();
+}
+
 ///------------------LIST--------------------------
 
-List::List(const List& other)
-        : list{},
-          step(other.step),
-          max_size(other.max_size)
-{
-    for (Literal* el : other.list) {
-        switch (el->get_type()) {
-            case LITERAL_TYPE::DOUBLE :{
-                list.push_back(new Double(el->get_double()));
-                break;
-            }
-            case LITERAL_TYPE::LIST :{
-                list.push_back(new List(el->get_list()));
-                break;
-            }
+List::Node::Node(std::vector<double> numbers, elements_type elements, double step, int max_size)
+        : owned_numbers(std::move(numbers)),
+          owned_elements(std::move(elements)),
+          number_span(owned_numbers),
+          element_span(owned_elements),
+          count(owned_elements.empty() ? owned_numbers.size() : owned_elements.size()),
+          numeric(owned_elements.empty()),
+          step(step),
+          max_size(max_size)
+{}
+
+List::Node::Node(const std::shared_ptr<const Node>& node, std::size_t begin, std::size_t end, int max_size)
+        : base(node->base ? node->base : node),
+          count(end - begin),
+          numeric(node->is_numeric()),
+          step(node->step),
+          max_size(max_size)
+{
+    if (numeric)
+        number_span = node->numbers().subspan(begin, end - begin);
+    else
+        element_span = node->elements().subspan(begin, end - begin);
+}
+
+List::Node::~Node()
+{
+    if (owned_elements.empty() && !base && !left)
+        return;
+
+    /// Reused by the thread, the nodes freed while it is being emptied add theirs to it.
+    static thread_local std::vector<std::shared_ptr<const Node>> released;
+    static thread_local bool releasing = false;
+
+    /// Moves @p child to released if it is freed with its parent and holds other
+    /// nodes, interned nodes may still be looked up by HashCons. The nodes holding
+    /// only numbers are freed as usual, without taking space in released.
+    auto take = [&](std::shared_ptr<const Node>& child) {
+        if (child && child.use_count() == 1 && !child->canonical &&
+            (!child->owned_elements.empty() || child->base || child->left))
+        {
+            released.push_back(std::move(child));
         }
+    };
+
+    /// Moves the nodes of @p node and of the lists among its elements to released.
+    auto release = [&](Node& node) {
+        for (element_type& element : node.owned_elements) {
+            if (element.use_count() == 1 && element->get_type() == LITERAL_TYPE::LIST)
+                take(const_cast<List&>(static_cast<const List&>(*element)).node);
+        }
+
+        take(node.base);
+        take(node.left);
+        take(node.right);
+        node.owned_elements.clear();
+    };
+
+    release(*this);
+    if (releasing)
+        return;
+
+    releasing = true;
+    while (!released.empty()) {
+        std::shared_ptr<const Node> node = std::move(released.back());
+        released.pop_back();
+        release(const_cast<Node&>(*node));
     }
+    releasing = false;
 }
 
+List::Node::Node(std::shared_ptr<const Node> left, std::shared_ptr<const Node> right)
+        : left(std::move(left)),
+          right(std::move(right)),
+          count(this->left->size() + this->right->size()),
+          numeric(this->left->is_numeric() && this->right->is_numeric()),
+          height(1 + std::max(this->left->height, this->right->height)),
+          step(1),
+          max_size((int) count)
+{}
 
-List::List(const list_type& list)
-        : list{},
-          max_size(list.size())
-{
-    for (Literal* el : list) {
-        switch (el->get_type()) {
-            case LITERAL_TYPE::DOUBLE :{
-                this->list.push_back(new Double(el->get_double()));
-                break;
+std::span<const double> List::Node::numbers() const
+{
+    flatten();
+    return number_span;
+}
+
+std::span<const List::element_type> List::Node::elements() const
+{
+    flatten();
+    return element_span;
+}
+
+void List::Node::flatten() const
+{
+    if (!is_concatenation())
+        return;
+
+    std::call_once(flattened, [this] {
+        Metrics::count_list_nodes_copied(count);
+
+        if (numeric)
+            owned_numbers.reserve(count);
+        else
+            owned_elements.reserve(count);
+
+        std::vector<const Node*> stack{this};
+        while (!stack.empty()) {
+            const Node* current = stack.back();
+            stack.pop_back();
+
+            if (current->is_concatenation()) {
+                stack.push_back(current->right.get());
+                stack.push_back(current->left.get());
+            } else if (numeric) {
+                owned_numbers.insert(owned_numbers.end(), current->number_span.begin(), current->number_span.end());
+            } else if (current->is_numeric()) {
+                for (double number : current->number_span)
+                    owned_elements.push_back(std::make_shared<const Double>(number));
+            } else {
+                owned_elements.insert(owned_elements.end(), current->element_span.begin(), current->element_span.end());
             }
-            case LITERAL_TYPE::LIST :{
-                this->list.push_back(new List(el->get_list()));
-                break;
+        }
+
+        number_span = owned_numbers;
+        element_span = owned_elements;
+    });
+}
+
+std::pair<const List::Node*, std::size_t> List::Node::find(std::size_t index) const
+{
+    const Node* current = this;
+
+    while (current->is_concatenation()) {
+        if (index < current->left->size()) {
+            current = current->left.get();
+        } else {
+            index -= current->left->size();
+            current = current->right.get();
+        }
+    }
+
+    return {current, index};
+}
+
+std::shared_ptr<const List::Node> List::concatenation(std::shared_ptr<const Node> left,
+                                                      std::shared_ptr<const Node> right) const
+{
+    count_allocation(sizeof(Node));
+    return std::make_shared<const Node>(std::move(left), std::move(right));
+}
+
+std::shared_ptr<const List::Node> List::join(std::shared_ptr<const Node> left, std::shared_ptr<const Node> right) const
+{
+    if (left->size() == 0)
+        return right;
+    if (right->size() == 0)
+        return left;
+
+    /// Small lists are copied, so the tree does not end in many small nodes.
+    if (left->size() + right->size() <= ROPE_LEAF_SIZE) {
+        Metrics::count_list_nodes_copied(left->size() + right->size());
+
+        if (left->is_numeric() && right->is_numeric()) {
+            std::vector<double> numbers(left->numbers().begin(), left->numbers().end());
+            numbers.insert(numbers.end(), right->numbers().begin(), right->numbers().end());
+
+            count_allocation(sizeof(Node) + numbers.size() * sizeof(double));
+            return make_node(std::move(numbers), 1, 0);
+        }
+
+        elements_type elements;
+        for (const std::shared_ptr<const Node>& part : {left, right}) {
+            for (std::size_t i = 0; i < part->size(); ++i) {
+                auto [leaf, index] = part->find(i);
+                if (leaf->is_numeric())
+                    elements.push_back(std::make_shared<const Double>(leaf->number_span[index]));
+                else
+                    elements.push_back(leaf->element_span[index]);
             }
         }
+
+        count_allocation(sizeof(Node) + elements.size() * LIST_NODE_SIZE);
+        return make_node(std::move(elements), 1, 0);
+    }
+
+    /// The taller tree is descended until the heights differ by at most one, then
+    /// the nodes on the way up are rotated as in an AVL tree.
+    if (left->height > right->height + 1) {
+        std::shared_ptr<const Node> joined = join(left->right, std::move(right));
+
+        if (joined->height <= left->left->height + 1)
+            return join(left->left, std::move(joined));
+
+        if (joined->left->height > joined->right->height) {
+            return join(join(left->left, joined->left->left),
+                        join(joined->left->right, joined->right));
+        }
+
+        return join(join(left->left, joined->left), joined->right);
+    }
+
+    if (right->height > left->height + 1) {
+        std::shared_ptr<const Node> joined = join(std::move(left), right->left);
+
+        if (joined->height <= right->right->height + 1)
+            return join(std::move(joined), right->right);
+
+        if (joined->right->height > joined->left->height) {
+            return join(join(joined->left, joined->right->left),
+                        join(joined->right->right, right->right));
+        }
+
+        return join(joined->left, join(joined->right, right->right));
     }
+
+    return concatenation(std::move(left), std::move(right));
+}
+
+std::pair<std::shared_ptr<const List::Node>, std::shared_ptr<const List::Node>>
+List::split(const std::shared_ptr<const Node>& node, std::size_t index) const
+{
+    if (!node->is_concatenation())
+        return {window(node, 0, index), window(node, index, node->size())};
+
+    std::size_t left_size = node->left->size();
+
+    if (index <= left_size) {
+        auto [first, rest] = split(node->left, index);
+        return {std::move(first), join(std::move(rest), node->right)};
+    }
+
+    auto [first, rest] = split(node->right, index - left_size);
+    return {join(node->left, std::move(first)), std::move(rest)};
+}
+
+std::shared_ptr<const List::Node> List::window(const std::shared_ptr<const Node>& node,
+                                               std::size_t begin,
+                                               std::size_t end) const
+{
+    if (begin == 0 && end == node->size())
+        return node;
+
+    if (begin == end)
+        return empty_node();
+
+    if (node->is_concatenation())
+        return split(split(node, end).first, begin).second;
+
+    /// Stored as numbers if the elements in the slice are all numbers.
+    if (!node->is_numeric()) {
+        std::span<const element_type> elements = node->elements().subspan(begin, end - begin);
+        bool numeric = std::all_of(elements.begin(), elements.end(), [](const element_type& el) {
+            return el->get_type() == LITERAL_TYPE::DOUBLE;
+        });
+
+        if (numeric) {
+            Metrics::count_list_nodes_copied(elements.size());
+            count_allocation(sizeof(Node) + elements.size() * sizeof(double));
+            return make_node(elements_type(elements.begin(), elements.end()), 1, 0);
+        }
+    }
+
+    count_allocation(sizeof(Node));
+    return make_node(std::make_shared<Node>(node, begin, end, 0));
+}
+
+std::shared_ptr<const List::Node> List::make_node(std::shared_ptr<Node> node)
+{
+    if (node->max_size != -1)
+        node->max_size = (int) node->size();
+
+    if (HashCons::is_enabled())
+        return HashCons::intern(std::move(node));
+
+    return node;
+}
+
+std::shared_ptr<const List::Node> List::make_node(std::vector<double> numbers, double step, int max_size)
+{
+    return make_node(std::make_shared<Node>(std::move(numbers), elements_type{}, step, max_size));
+}
+
+std::shared_ptr<const List::Node> List::make_node(elements_type elements, double step, int max_size)
+{
+    /// The numbers of lists are doubles, unless a double would round them.
+    auto is_double = [](const element_type& el) {
+        return el->get_type() == LITERAL_TYPE::DOUBLE ||
+               el->get_type() == LITERAL_TYPE::INTEGER && static_cast<const Integer&>(*el).is_exact_double();
+    };
+
+    bool numeric = std::all_of(elements.begin(), elements.end(), is_double);
+
+    if (!numeric) {
+        for (element_type& el : elements) {
+            if (el->get_type() == LITERAL_TYPE::INTEGER && is_double(el))
+                el = std::make_shared<const Double>(el->get_double());
+        }
+
+        return make_node(std::make_shared<Node>(std::vector<double>{}, std::move(elements), step, max_size));
+    }
+
+    std::vector<double> numbers;
+    numbers.reserve(elements.size());
+    for (const element_type& el : elements)
+        numbers.push_back(el->get_double());
+
+    return make_node(std::move(numbers), step, max_size);
+}
+
+Literal::element_type List::copy_element(const Literal* element)
+{
+    if (element->get_type() == LITERAL_TYPE::INTEGER)
+        return std::make_shared<const Integer>(static_cast<const Integer*>(element)->get_integer());
+
+    if (element->is_number())
+        return std::make_shared<const Double>(element->get_double());
+
+    /// Shares the node of the list.
+    return std::make_shared<const List>(*static_cast<const List*>(element));
+}
+
+List::List(std::shared_ptr<const Node> node)
+        : node(std::move(node))
+{
+    count_allocation(sizeof(List));
+}
+
+List::List(const List& other)
+        : Literal(other),
+          node(other.node)
+{
+    count_allocation(sizeof(List));
+}
+
+List::List(const list_type& list)
+{
+    count_allocation(sizeof(List) + sizeof(Node) + list.size() * LIST_NODE_SIZE);
+    Metrics::count_list_nodes_copied(list.size());
+
+    elements_type elements;
+    elements.reserve(list.size());
+
+    for (Literal* el : list)
+        elements.push_back(copy_element(el));
+
+    node = make_node(std::move(elements), 1, (int) list.size());
+}
+
+List::List(std::span<const double> numbers)
+        : List(std::vector<double>(numbers.begin(), numbers.end()))
+{}
+
+List::List(std::vector<double> numbers, double step, int max_size)
+{
+    if (max_size == -1 && numbers.empty())
+        throw std::invalid_argument("List :: An infinite list needs a first element.");
+
+    count_allocation(sizeof(List) + sizeof(Node) + numbers.size() * sizeof(double));
+    node = make_node(std::move(numbers), step, max_size);
+}
+
+List::List(std::vector<std::unique_ptr<Literal>> elements)
+{
+    count_allocation(sizeof(List) + sizeof(Node) + elements.size() * LIST_NODE_SIZE);
+
+    elements_type shared;
+    shared.reserve(elements.size());
+
+    for (std::unique_ptr<Literal>& el : elements)
+        shared.push_back(std::move(el));
+
+    node = make_node(std::move(shared), 1, 0);
+}
+
+List::List(elements_type elements)
+{
+    count_allocation(sizeof(List) + sizeof(Node) + elements.size() * LIST_NODE_SIZE);
+    node = make_node(std::move(elements), 1, 0);
 }
 
 List::List(double initial_value, double step, int max_size)
-    : list(),
-      step(step),
-      max_size(max_size)
 {
-    int max = max_size == -1 ? 10 : max_size;
-    if (max_size != 0)
-        list.push_back(new Double(initial_value));
+    int max = std::max(max_size == -1 ? 10 : max_size, 0);
+    count_allocation(sizeof(List) + sizeof(Node) + max * sizeof(double));
+
+    std::vector<double> numbers;
+    numbers.reserve(max);
+
+    if (max != 0)
+        numbers.push_back(initial_value);
 
     for (int i = 1; i < max; ++i)
-        list.push_back(new Double(list.back()->get_double() + step));
+        numbers.push_back(numbers.back() + step);
+
+    node = make_node(std::move(numbers), step, max_size);
 }
 
 double List::get_double() const
@@ -141,55 +620,188 @@ double List::get_double() const
     throw std::invalid_argument("Literal :: get_double() -> Incorrect type, actual type is List.");
 }
 
-const Literal::list_type& List::get_list() const
+std::span<const double> List::get_numbers() const
+{
+    if (!node->is_numeric())
+        throw std::invalid_argument("List :: get_numbers() -> Not all elements are numbers.");
+
+    return node->numbers();
+}
+
+bool List::is_numeric() const
+{
+    return node->is_numeric();
+}
+
+std::size_t List::size() const
+{
+    return node->size();
+}
+
+Literal::element_type List::at(std::size_t index) const
+{
+    assert(index < size());
+
+    auto [leaf, i] = node->find(index);
+    if (leaf->is_numeric())
+        return std::make_shared<const Double>(leaf->numbers()[i]);
+
+    return leaf->elements()[i];
+}
+
+double List::number_at(std::size_t index) const
 {
-    return list;
+    assert(index < size());
+
+    auto [leaf, i] = node->find(index);
+    if (leaf->is_numeric())
+        return leaf->numbers()[i];
+
+    return leaf->elements()[i]->get_double();
 }
 
-const Literal* List::head() const
+Literal::element_type List::head() const
 {
-    if (list.empty())
+    if (size() == 0)
         throw std::invalid_argument("List :: head() on empty list.");
 
-    return list.front();
+    return at(0);
 }
 
 List List::tail() const
 {
-    if (list.empty())
+    if (size() == 0)
         throw std::invalid_argument("List :: tail() on empty list.");
 
-    List res = *this;
-    res.list.pop_front();
+    /// The tail of a finite list shares its elements.
+    if (node->max_size != -1)
+        return slice(1, size());
+
+    Metrics::count_list_nodes_copied(size() - 1);
+
+    if (node->is_numeric()) {
+        std::span<const double> list = node->numbers();
+        std::vector<double> numbers;
+        numbers.reserve(list.size());
+        numbers.assign(list.begin() + 1, list.end());
+        numbers.push_back(list.back() + node->step);
+
+        count_allocation(sizeof(Node) + numbers.size() * sizeof(double));
+        return List(make_node(std::move(numbers), node->step, node->max_size));
+    }
+
+    elements_type elements(node->elements().begin() + 1, node->elements().end());
 
-    if (max_size == -1)
-        res.list.push_back(new Double(list.back()->get_double() + step));
+    /// The generated elements of an infinite list are numbers.
+    elements.push_back(std::make_shared<const Double>(number_at(size() - 1) + node->step));
 
-    return res;
+    count_allocation(sizeof(Node) + elements.size() * LIST_NODE_SIZE);
+    return List(make_node(std::move(elements), node->step, node->max_size));
 }
 
-int List::length() const
+Literal::element_type List::nth(std::size_t index) const
 {
-    return max_size == -1 ? -1 : (int)list.size();
+    if (index < size())
+        return at(index);
+
+    if (node->max_size != -1)
+        throw std::invalid_argument("List :: nth() -> Index " + std::to_string(index) +
+                                    " is past the end of a list of length " + std::to_string(size()) + ".");
+
+    /// The generated elements of an infinite list are numbers.
+    return std::make_shared<const Double>(number_at(size() - 1) + (double) (index - size() + 1) * node->step);
 }
 
-double List::get_step() const
+List List::generate(std::size_t begin, std::size_t end, double step, int max_size) const
+{
+    /// The sizes of lists are ints.
+    if (end - begin > (std::size_t) std::numeric_limits<int>::max())
+        throw std::invalid_argument("List :: generate() -> Cannot generate " + std::to_string(end - begin) +
+                                    " elements of an endless list.");
+
+    Metrics::count_list_nodes_copied(end - begin);
+
+    if (node->is_numeric()) {
+        std::vector<double> numbers;
+        numbers.reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i)
+            numbers.push_back(i < size() ? node->numbers()[i] : node->numbers().back() + (double) (i - size() + 1) * node->step);
+
+        count_allocation(sizeof(Node) + numbers.size() * sizeof(double));
+        return List(make_node(std::move(numbers), step, max_size));
+    }
+
+    elements_type elements;
+    elements.reserve(end - begin);
+    for (std::size_t i = begin; i < end; ++i)
+        elements.push_back(nth(i));
+
+    count_allocation(sizeof(Node) + elements.size() * LIST_NODE_SIZE);
+    return List(make_node(std::move(elements), step, max_size));
+}
+
+List List::slice(std::size_t begin, std::size_t end) const
+{
+    if (begin > end)
+        throw std::invalid_argument("List :: slice() -> The beginning is after the end.");
+
+    if (node->max_size == -1)
+        return generate(begin, end, 1, 0);
+
+    end = std::min(end, size());
+    begin = std::min(begin, end);
+
+    if (begin == 0 && end == size())
+        return *this;
+
+    return List(window(node, begin, end));
+}
+
+List List::take(std::size_t n) const
 {
-    return step;
+    return slice(0, n);
 }
 
-void List::print(std::ostream& os) const
+List List::drop(std::size_t n) const
 {
-    if (list.empty()) {
-        os << "[]";
-    } else {
-        auto end = list.end();
+    if (node->max_size != -1)
+        return slice(std::min(n, size()), size());
+
+    if (n > SIZE_MAX - size())
+        throw std::invalid_argument("List :: drop() -> Cannot drop " + std::to_string(n) + " elements of an endless list.");
+
+    /// An infinite list keeps the number of its generated elements.
+    return generate(n, n + size(), node->step, -1);
+}
+
+List List::reverse() const
+{
+    if (node->max_size == -1)
+        throw std::invalid_argument("List :: reverse() -> Cannot reverse an endless list.");
 
-        os << '[' << *list.front();
-        for (auto it = ++list.begin(); it != end; ++it)
-            os << ' ' << *(*it);
-        os << (max_size == -1 ? " ...]" : "]");
+    Metrics::count_list_nodes_copied(size());
+
+    if (node->is_numeric()) {
+        std::vector<double> numbers(node->numbers().rbegin(), node->numbers().rend());
+
+        count_allocation(sizeof(Node) + numbers.size() * sizeof(double));
+        return List(make_node(std::move(numbers), 1, 0));
     }
+
+    elements_type elements(node->elements().rbegin(), node->elements().rend());
+
+    count_allocation(sizeof(Node) + elements.size() * LIST_NODE_SIZE);
+    return List(make_node(std::move(elements), 1, 0));
+}
+
+int List::length() const
+{
+    return node->max_size == -1 ? -1 : (int) size();
+}
+
+double List::get_step() const
+{
+    return node->step;
 }
 
 List List::to_list() const
@@ -198,35 +810,256 @@ List List::to_list() const
 }
 
 List::List()
-    : step(0),
-      max_size(0)
+        : node(empty_node())
 {}
 
+const std::shared_ptr<const List::Node>& List::empty_node()
+{
+    /// All empty lists share one node.
+    static const std::shared_ptr<const Node> empty =
+            std::make_shared<const Node>(std::vector<double>{}, elements_type{}, 0.0, 0);
+    return empty;
+}
+
 List List::concat(const List& other) const
 {
-    if (max_size == -1)
+    if (node->max_size == -1)
         throw std::invalid_argument("List :: cannot concatenate to an endless list");
 
-    list_type result = list;
+    /// The elements of an infinite list, or of a list in the table
+    /// of HashCons, are held by one node.
+    if (other.node->max_size != -1 && !HashCons::is_enabled())
+        return List(join(node, other.node));
 
-    for (Literal* el : other.list)
-        result.push_back(el);
+    std::size_t n = size() + other.size();
+    Metrics::count_list_nodes_copied(n);
 
-    List new_list(result);
+    double step = other.node->max_size == -1 ? other.node->step : 1;
 
-    if (other.max_size == -1) {
-        new_list.max_size = -1;
-        new_list.step = other.step;
+    if (node->is_numeric() && other.node->is_numeric()) {
+        std::vector<double> numbers;
+        numbers.reserve(n);
+        numbers.insert(numbers.end(), node->numbers().begin(), node->numbers().end());
+        numbers.insert(numbers.end(), other.node->numbers().begin(), other.node->numbers().end());
+
+        count_allocation(sizeof(Node) + n * sizeof(double));
+        return List(make_node(std::move(numbers), step, other.node->max_size));
     }
 
-    return new_list;
+    elements_type elements;
+    elements.reserve(n);
+    for (std::size_t i = 0; i < size(); ++i)
+        elements.push_back(at(i));
+    for (std::size_t i = 0; i < other.size(); ++i)
+        elements.push_back(other.at(i));
+
+    count_allocation(sizeof(Node) + n * LIST_NODE_SIZE);
+    return List(make_node(std::move(elements), step, other.node->max_size));
+}
+
+List List::sort() const
+{
+    if (node->max_size == -1)
+        throw std::invalid_argument("List :: sort() -> Cannot sort an endless list.");
+
+    Metrics::count_list_nodes_copied(size());
+
+    std::span<const double> list = get_numbers();
+    std::vector<double> numbers(list.begin(), list.end());
+    NumericKernels::sort(numbers);
+
+    count_allocation(sizeof(Node) + numbers.size() * sizeof(double));
+    return List(make_node(std::move(numbers), 1, 0));
+}
+
+List List::unique() const
+{
+    if (node->max_size == -1)
+        throw std::invalid_argument("List :: unique() -> Cannot remove the repeating elements of an endless list.");
+
+    if (node->is_numeric()) {
+        std::span<const double> list = node->numbers();
+
+        /// The positions in the order of the numbers, with the NaNs last,
+        /// so the equal numbers are next to each other.
+        std::vector<std::size_t> order(list.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](std::size_t i, std::size_t j) {
+            return list[i] < list[j] || !std::isnan(list[i]) && std::isnan(list[j]);
+        });
+
+        /// The first position of every group of equal numbers.
+        std::vector<std::size_t> first;
+        double group = 0;
+        for (std::size_t i : order) {
+            if (first.empty() || !(std::abs(list[i] - group) < 0.00001)) {
+                group = list[i];
+                first.push_back(i);
+            } else {
+                first.back() = std::min(first.back(), i);
+            }
+        }
+        std::sort(first.begin(), first.end());
+
+        std::vector<double> numbers;
+        numbers.reserve(first.size());
+        for (std::size_t i : first)
+            numbers.push_back(list[i]);
+
+        Metrics::count_list_nodes_copied(numbers.size());
+        count_allocation(sizeof(Node) + numbers.size() * sizeof(double));
+        return List(make_node(std::move(numbers), 1, 0));
+    }
+
+    elements_type elements;
+    for (const element_type& element : node->elements()) {
+        bool repeated = std::any_of(elements.begin(), elements.end(), [&](const element_type& other) {
+            return equal(*element, *other);
+        });
+        if (!repeated)
+            elements.push_back(element);
+    }
+
+    Metrics::count_list_nodes_copied(elements.size());
+    count_allocation(sizeof(Node) + elements.size() * LIST_NODE_SIZE);
+    return List(make_node(std::move(elements), 1, 0));
+}
+
+int List::index_of(const Literal& value) const
+{
+    if (node->max_size == -1)
+        throw std::invalid_argument("List :: index_of() -> Cannot search an endless list.");
+
+    if (node->is_numeric() && value.is_number()) {
+        double number = value.get_double();
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (std::abs(node->numbers()[i] - number) < 0.00001)
+                return (int) i;
+        }
+
+        return -1;
+    }
+
+    for (std::size_t i = 0; i < size(); ++i) {
+        if (equal(*at(i), value))
+            return (int) i;
+    }
+
+    return -1;
+}
+
+int List::binary_search(double value) const
+{
+    if (node->max_size == -1)
+        throw std::invalid_argument("List :: binary_search() -> Cannot search an endless list.");
+
+    std::span<const double> numbers = get_numbers();
+    auto it = std::lower_bound(numbers.begin(), numbers.end(), value - 0.00001);
+
+    if (it == numbers.end() || std::abs(*it - value) >= 0.00001)
+        return -1;
+
+    return (int) (it - numbers.begin());
+}
+
+std::pair<List::Node*, List::Node*> List::reusable_nodes() const
+{
+    const std::shared_ptr<const Node>& owner = node->base ? node->base : node;
+
+    if (node.use_count() != 1 || owner.use_count() != 1 || node->canonical || owner->canonical ||
+        !node->is_numeric() || node->is_concatenation() || owner->is_concatenation()) {
+        return {nullptr, nullptr};
+    }
+
+    /// The nodes are built by make_shared<Node>() but for the empty node and the
+    /// concatenations, which are never reusable, so they may be modified.
+    return {const_cast<Node*>(node.get()), const_cast<Node*>(owner.get())};
+}
+
+bool List::is_reusable() const
+{
+    return reusable_nodes().first != nullptr;
+}
+
+std::span<double> List::numbers_in_place(double step)
+{
+    auto [list, owner] = reusable_nodes();
+    assert(list);
+
+    list->step = step;
+    if (list->count == 0)
+        return {};
+
+    Metrics::count_list_reused();
+    return {owner->owned_numbers.data() + (list->number_span.data() - owner->owned_numbers.data()), list->count};
+}
+
+bool List::tail_in_place()
+{
+    if (size() == 0 || !is_reusable())
+        return false;
+
+    if (node->max_size != -1)
+        return slice_in_place(1, size());
+
+    std::span<double> numbers = numbers_in_place(node->step);
+    double next = numbers.back() + node->step;
+    std::copy(numbers.begin() + 1, numbers.end(), numbers.begin());
+    numbers.back() = next;
+    return true;
+}
+
+bool List::slice_in_place(std::size_t begin, std::size_t end)
+{
+    auto [list, owner] = reusable_nodes();
+    if (!list || list->max_size == -1 || begin > end)
+        return false;
+
+    end = std::min(end, size());
+    begin = std::min(begin, end);
+
+    Metrics::count_list_reused();
+    list->number_span = list->number_span.subspan(begin, end - begin);
+    list->count = end - begin;
+    list->max_size = (int) list->count;
+    list->shape.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+bool List::take_in_place(std::size_t n)
+{
+    return slice_in_place(0, n);
+}
+
+bool List::drop_in_place(std::size_t n)
+{
+    return slice_in_place(std::min(n, size()), size());
+}
+
+bool List::reverse_in_place()
+{
+    if (node->max_size == -1 || !is_reusable())
+        return false;
+
+    std::span<double> numbers = numbers_in_place(1);
+    std::reverse(numbers.begin(), numbers.end());
+    return true;
+}
+
+bool List::sort_in_place()
+{
+    if (node->max_size == -1 || !is_reusable())
+        return false;
+
+    NumericKernels::sort(numbers_in_place(1));
+    return true;
 }
 
 double List::to_double() const
 {
-    if (list.size() != 1)
+    if (size() != 1)
         throw std::invalid_argument("List :: Only lists with one member can be converted to double");
-    return list.front()->get_double();
+    return number_at(0);
 }
 
 LITERAL_TYPE List::get_type() const
@@ -235,39 +1068,87 @@ LITERAL_TYPE List::get_type() const
 }
 
 List::List(List&& other)
-    : list(std::move(other.list)),
-      step(other.step),
-      max_size(other.max_size)
+    : node(other.node)
 {}
 
-List::~List()
+List::~List() = default;
+
+std::size_t List::shape() const
 {
-    for (Literal* el : list)
-        delete el;
+    std::size_t hash = node->shape.load(std::memory_order_acquire);
+    if (hash)
+        return hash;
+
+    std::size_t n = size();
+
+    /// A number is equal to the list containing only it.
+    if (node->max_size != -1 && n == 1 && (node->is_numeric() || shape(*node->elements().front()) == SCALAR_SHAPE)) {
+        hash = SCALAR_SHAPE;
+    } else {
+        hash = combine((std::size_t) length(), n);
+        for (std::size_t i = 0; i < n; ++i)
+            hash = combine(hash, node->is_numeric() ? SCALAR_SHAPE : shape(*node->elements()[i]));
+
+        if (hash <= SCALAR_SHAPE)
+            hash += 2;
+    }
+
+    node->shape.store(hash, std::memory_order_release);
+    return hash;
+}
+
+std::size_t List::shape(const Literal& literal)
+{
+    if (literal.is_number())
+        return SCALAR_SHAPE;
+
+    return static_cast<const List&>(literal).shape();
 }
 
 bool List::operator==(const Literal& other) const
 {
-    if (other.get_type() == LITERAL_TYPE::DOUBLE)
-        /// Causes compiler warning,
-        /// but actually this calls the (==) method of Double.
-        return other == *this;
+    if (other.is_number())
+        /// Called explicitly, in C++20 "other == *this" may
+        /// resolve to this method with reversed arguments.
+        return other.operator==(*this);
 
-    if (length() != other.length())
+    const List& list = static_cast<const List&>(other);
+
+    /// Copies of a list, and with hash-consing all equal lists, share their node.
+    if (node == list.node)
+        return true;
+
+    if (length() != list.length() || size() != list.size())
+        return false;
+
+    if (is_numeric() && list.is_numeric())
+        return NumericKernels::equal(node->numbers(), list.node->numbers(), 0.00001);
+
+    if (shape() != list.shape())
         return false;
 
-    auto aend = list.end();
-    for (auto ait = list.begin(), bit = ((const List&)other).list.begin();
-         ait != aend;
-         ++ait, ++bit)
-    {
-        if (*(*ait) != *(*bit))
+    for (std::size_t i = 0; i < size(); ++i) {
+        if (*at(i) != *list.at(i))
             return false;
     }
 
     return true;
 }
 
+bool List::equal(const Literal& a, const Literal& b)
+{
+    bool a_number = a.is_number();
+    bool b_number = b.is_number();
+
+    if (a_number == b_number)
+        return a == b;
+
+    if (a_number)
+        return b.length() == 1 && a == *b.head();
+
+    return a.length() == 1 && *a.head() == b;
+}
+
 bool List::operator!=(const Literal& other) const
 {
     return !(*this == other);
@@ -275,11 +1156,13 @@ bool List::operator!=(const Literal& other) const
 
 List::operator bool() const
 {
-    return !list.empty();
+    return size() != 0;
 }
 
 std::ostream& operator<<(std::ostream& os, const Literal& literal)
 {
-    literal.print(os);
+    OutputBuffer buffer(os, 256);
+    buffer.set_precision(std::clamp((int) os.precision(), 1, OutputBuffer::MAX_PRECISION));
+    buffer.write(literal);
     return os;
 }
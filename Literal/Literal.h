@@ -1,13 +1,24 @@
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "BigInteger.h"
+#include "Metrics.h"
 
 /**
  * @brief - Enum with the types of the literals
  */
 enum class LITERAL_TYPE {
     DOUBLE,
+    INTEGER,
     LIST
 };
 
@@ -20,89 +31,461 @@ class Literal {
 public:
     using list_type = std::list<Literal*>;
 
+    /// Literals are immutable once they are elements of a list,
+    /// so the copies of a list share its elements.
+    using element_type = std::shared_ptr<const Literal>;
+    using elements_type = std::vector<element_type>;
+
+private:
+    static inline thread_local std::size_t bytes_allocated = 0;
+    static inline thread_local std::size_t literals_allocated = 0;
+
 protected:
-    virtual void print(std::ostream& os) const = 0;
+    /// Approximate size of an element of a list, without the element itself.
+    static constexpr std::size_t LIST_NODE_SIZE = sizeof(element_type);
+
+    void count_allocation(std::size_t bytes) const
+    {
+        bytes_allocated += bytes;
+        AllocationTracker::on_bytes(this, bytes);
+    }
+
+    Literal()
+    {
+        ++literals_allocated;
+        Metrics::count_literal_allocated();
+        AllocationTracker::on_allocate(this);
+    }
+
+    Literal(const Literal&)
+            : Literal()
+    {}
+
+    Literal& operator=(const Literal&) = default;
+
+public:
+    /**
+     * @returns - The number of bytes allocated for literals and
+     *            their list nodes by the calling thread so far.
+     */
+    static std::size_t allocated_bytes()
+    {
+        return bytes_allocated;
+    }
+
+    /**
+     * @returns - The number of literals allocated by the calling thread so far.
+     */
+    static std::size_t allocation_count()
+    {
+        return literals_allocated;
+    }
 
 public:
-    virtual double           get_double()                     const =       0;
-    virtual const list_type& get_list()                       const =       0;
-    virtual const Literal*   head()                           const =       0;
-    virtual List             tail()                           const =       0;
-    virtual int              length()                         const =       0;
-    virtual double           get_step()                       const =       0;
-    virtual List             to_list()                        const =       0;
-    virtual double           to_double()                      const =       0;
-    virtual List             concat(const List& other)        const =       0;
-    virtual LITERAL_TYPE     get_type()                       const =       0;
-    virtual                  ~Literal()                             = default;
-    virtual bool             operator==(const Literal& other) const =       0;
-    virtual bool             operator!=(const Literal& other) const =       0;
-    virtual operator         bool()                           const =       0;
+    virtual double                  get_double()                     const =       0;
+    virtual std::span<const double> get_numbers()                    const =       0;
+    virtual element_type            head()                           const =       0;
+    virtual List                    tail()                           const =       0;
+    virtual int                     length()                         const =       0;
+    virtual double                  get_step()                       const =       0;
+    virtual List                    to_list()                        const =       0;
+    virtual double                  to_double()                      const =       0;
+    virtual List                    concat(const List& other)        const =       0;
+    virtual LITERAL_TYPE            get_type()                       const =       0;
+    virtual                         ~Literal();
+    virtual bool                    operator==(const Literal& other) const =       0;
+    virtual bool                    operator!=(const Literal& other) const =       0;
+    virtual operator                bool()                           const =       0;
 
     friend  std::ostream& operator<<(std::ostream& os, const Literal& literal);
+
+    /**
+     * @returns - Whether the literal is a number, a Double or an Integer.
+     */
+    bool is_number() const
+    {
+        return get_type() != LITERAL_TYPE::LIST;
+    }
 };
 
 /**
  * @brief - Literal of type double
  */
-class Double : public Literal {
+class Double final : public Literal {
     double value;
 
-protected:
-    void print(std::ostream& os) const override;
-
 public:
     Double(double value);
 
-    double           get_double()                     const override;
-    const list_type& get_list()                       const override;
-    const Literal*   head()                           const override;
-    List             tail()                           const override;
-    int              length()                         const override;
-    double           get_step()                       const override;
-    List             to_list()                        const override;
-    double           to_double()                      const override;
-    List             concat(const List& other)        const override;
-    LITERAL_TYPE     get_type()                       const override;
-    bool             operator==(const Literal& other) const override;
-    bool             operator!=(const Literal& other) const override;
-    operator         bool()                           const override;
+    double                  get_double()                     const override;
+    std::span<const double> get_numbers()                    const override;
+    element_type            head()                           const override;
+    List                    tail()                           const override;
+    int                     length()                         const override;
+    double                  get_step()                       const override;
+    List                    to_list()                        const override;
+    double                  to_double()                      const override;
+    List                    concat(const List& other)        const override;
+    LITERAL_TYPE            get_type()                       const override;
+    bool                    operator==(const Literal& other) const override;
+    bool                    operator!=(const Literal& other) const override;
+    operator                bool()                           const override;
+};
+
+/**
+ * @brief - Literal of type integer, exact where a double is not past 2^53.
+ *          Integer literals are read as integers, of any size, which + - * %
+ *          and int() keep, as / does when it leaves no remainder. The other
+ *          operations give a Double, and the numbers stored in lists are
+ *          doubles, except the integers a double cannot hold exactly: a list
+ *          of them is a list of other elements, so it is not an operand of
+ *          element-wise operations.
+ */
+class Integer final : public Literal {
+    BigInteger value;
+
+public:
+    Integer(BigInteger value);
+
+    const BigInteger&       get_integer()                    const;
+
+    /**
+     * @returns - Whether a double holds the value exactly.
+     */
+    bool                    is_exact_double()                const;
+
+    double                  get_double()                     const override;
+    std::span<const double> get_numbers()                    const override;
+    element_type            head()                           const override;
+    List                    tail()                           const override;
+    int                     length()                         const override;
+    double                  get_step()                       const override;
+    List                    to_list()                        const override;
+    double                  to_double()                      const override;
+    List                    concat(const List& other)        const override;
+    LITERAL_TYPE            get_type()                       const override;
+    bool                    operator==(const Literal& other) const override;
+    bool                    operator!=(const Literal& other) const override;
+    operator                bool()                           const override;
 };
 
 /**
  * @brief - Literal of type List
+ *
+ *          The elements are held by a node, which is never modified once
+ *          it is shared, so copying a list only copies a pointer to its node.
+ *          The elements of a list of numbers only are stored as an array of
+ *          numbers, which the operations on lists process with NumericKernels.
+ *          The nodes of the slices of a list refer to the elements of
+ *          its node instead of copying them.
+ *          Concatenating finite lists builds a balanced tree of the nodes
+ *          of the lists instead of copying them (a rope), so lists built by
+ *          repeated concatenation take O(log n) per concat(), head() and tail().
+ *          The elements of a tree are copied into one array the first time
+ *          an operation needs them as an array.
+ *          A list of numbers which is the only one referring to its node and
+ *          its array may be modified in place instead, see is_reusable().
  */
 class List : public Literal {
-    list_type list{};
-    double    step      =  1;
+    struct Node {
+        /// The node owning the elements of a slice, null if this one owns them.
+        std::shared_ptr<const Node>   base;
 
-    /// Max size of -1 indicates infinite list
-    int       max_size  = -1;
+        /// The lists concatenated into this one, null for a node holding its elements.
+        std::shared_ptr<const Node>   left;
+        std::shared_ptr<const Node>   right;
 
-protected:
-    void print(std::ostream& os) const override;
+        /// The elements of a concatenation are only copied here when needed, see flatten().
+        mutable std::vector<double>   owned_numbers;
+        mutable elements_type         owned_elements;
+        mutable std::span<const double>       number_span;
+        mutable std::span<const element_type> element_span;
+        mutable std::once_flag                flattened;
+
+        std::size_t         count;
+        bool                numeric;
+
+        /// The height of the tree of a concatenation, 0 for the other nodes.
+        int                 height = 0;
+
+        double              step;
+
+        /// Max size of -1 indicates infinite list
+        int                 max_size;
+
+        /// Whether this is the one node of its structure, see HashCons.
+        bool                canonical = false;
+
+        /// The hash of the shape of the list, see shape(), 0 until it is computed.
+        mutable std::atomic<std::size_t> shape{0};
+
+        Node(std::vector<double> numbers, elements_type elements, double step, int max_size);
+
+        /**
+         * @brief - The elements of @p node from @p begin to @p end, without copying them.
+         */
+        Node(const std::shared_ptr<const Node>& node, std::size_t begin, std::size_t end, int max_size);
+
+        /**
+         * @brief - The concatenation of the finite lists @p left and @p right, without copying them.
+         */
+        Node(std::shared_ptr<const Node> left, std::shared_ptr<const Node> right);
+
+        /**
+         * @brief - Frees the lists among the elements, and the nodes of slices and
+         *          concatenations, level by level, so freeing a deeply nested
+         *          list does not recurse.
+         */
+        ~Node();
+
+        bool is_concatenation() const
+        {
+            return left != nullptr;
+        }
+
+        bool is_numeric() const
+        {
+            return numeric;
+        }
+
+        std::size_t size() const
+        {
+            return count;
+        }
+
+        /**
+         * @returns - The elements, when they are all numbers.
+         */
+        std::span<const double> numbers() const;
+
+        /**
+         * @returns - The elements otherwise.
+         */
+        std::span<const element_type> elements() const;
+
+        /**
+         * @brief - Copies the elements of a concatenation into one array, once.
+         */
+        void flatten() const;
+
+        /**
+         * @returns - The node holding the element at @p index and its index there.
+         */
+        std::pair<const Node*, std::size_t> find(std::size_t index) const;
+    };
+
+    std::shared_ptr<const Node> node;
+
+    /**
+     * @returns - The node and the node owning its numbers, which are
+     *            both null if the list is not reusable, see is_reusable().
+     */
+    std::pair<Node*, Node*> reusable_nodes() const;
+
+    /// Concatenations of at most this many elements are copied instead of joined.
+    static constexpr std::size_t ROPE_LEAF_SIZE = 64;
+
+    friend class HashCons;
+    friend class OutputBuffer;
+
+    explicit List(std::shared_ptr<const Node> node);
+
+    static std::shared_ptr<const Node> make_node(std::vector<double> numbers, double step, int max_size);
+
+    /**
+     * @brief - Stores the elements as numbers if they are all numbers.
+     */
+    static std::shared_ptr<const Node> make_node(elements_type elements, double step, int max_size);
+    static std::shared_ptr<const Node> make_node(std::shared_ptr<Node> node);
+
+    static element_type copy_element(const Literal* element);
+    static const std::shared_ptr<const Node>& empty_node();
+
+    /**
+     * @returns - The concatenation of @p left and @p right, balanced like an AVL tree.
+     */
+    std::shared_ptr<const Node> join(std::shared_ptr<const Node> left, std::shared_ptr<const Node> right) const;
+    std::shared_ptr<const Node> concatenation(std::shared_ptr<const Node> left, std::shared_ptr<const Node> right) const;
+
+    /**
+     * @returns - The first @p index elements of @p node and the rest.
+     */
+    std::pair<std::shared_ptr<const Node>, std::shared_ptr<const Node>> split(const std::shared_ptr<const Node>& node,
+                                                                              std::size_t index) const;
+
+    /**
+     * @returns - The elements of the finite list @p node from @p begin to @p end.
+     */
+    std::shared_ptr<const Node> window(const std::shared_ptr<const Node>& node, std::size_t begin, std::size_t end) const;
+
+    /**
+     * @returns - A copy of the elements of an infinite list from @p begin to @p end.
+     */
+    List generate(std::size_t begin, std::size_t end, double step, int max_size) const;
+
+    /**
+     * @returns - A hash of the lengths and the nesting of the list, which
+     *            equal lists have in common. The numbers are not part of it,
+     *            as they are equal within a tolerance.
+     *            Computed on the first call and kept in the node.
+     */
+    std::size_t shape() const;
+    static std::size_t shape(const Literal& literal);
 
 public:
     List();
     List(const List& other);
     List(List&& other);
     List(const list_type& list);
+    explicit List(std::span<const double> numbers);
+    /**
+     * @param max_size - -1 for an infinite list, which continues by @p step
+     *                   after the last of @p numbers.
+     */
+    explicit List(std::vector<double> numbers, double step = 1.0, int max_size = 0);
+
+    /**
+     * @brief - Takes the ownership of @p elements instead of copying them.
+     */
+    explicit List(std::vector<std::unique_ptr<Literal>> elements);
+
+    /**
+     * @brief - Shares @p elements with the lists they are taken from.
+     */
+    explicit List(elements_type elements);
     List(double initial_value, double step = 1.0, int max_size = -1);
     ~List();
 
-    double           get_double()                     const override;
-    const list_type& get_list()                       const override;
-    const Literal*   head()                           const override;
-    List             tail()                           const override;
-    int              length()                         const override;
-    double           get_step()                       const override;
-    List             to_list()                        const override;
-    double           to_double()                      const override;
-    List             concat(const List& other)        const override;
-    LITERAL_TYPE     get_type()                       const override;
-    bool             operator==(const Literal& other) const override;
-    bool             operator!=(const Literal& other) const override;
+    double                  get_double()                     const override;
+    std::span<const double> get_numbers()                    const override;
+    element_type            head()                           const override;
+    List                    tail()                           const override;
+    int                     length()                         const override;
+    double                  get_step()                       const override;
+    List                    to_list()                        const override;
+    double                  to_double()                      const override;
+    List                    concat(const List& other)        const override;
+    LITERAL_TYPE            get_type()                       const override;
+    bool                    operator==(const Literal& other) const override;
+    bool                    operator!=(const Literal& other) const override;
     operator bool() const override;
+
+    /**
+     * @returns - Whether the elements are all numbers, stored as an array.
+     */
+    bool is_numeric() const;
+
+    /**
+     * @returns - The number of elements stored, for an infinite
+     *            list the ones generated so far.
+     */
+    std::size_t size() const;
+
+    /**
+     * @returns - The element at @p index < size().
+     */
+    element_type at(std::size_t index) const;
+
+    /**
+     * @returns - The number at @p index < size().
+     *
+     * @throws std::invalid_argument - If the element is a list.
+     */
+    double number_at(std::size_t index) const;
+
+    /**
+     * @returns - The element at @p index, also past size() for an infinite list.
+     *
+     * @throws std::invalid_argument - If @p index is past the end of the list.
+     */
+    element_type nth(std::size_t index) const;
+
+    /**
+     * @returns - The elements from @p begin to @p end, at most to the end of the list.
+     *            Shares the elements of a finite list instead of copying them.
+     *
+     * @throws std::invalid_argument - If @p begin is after @p end.
+     */
+    List slice(std::size_t begin, std::size_t end) const;
+
+    /**
+     * @returns - The first @p n elements, at most all of them.
+     */
+    List take(std::size_t n) const;
+
+    /**
+     * @returns - The list without its first @p n elements, empty if it has less.
+     */
+    List drop(std::size_t n) const;
+
+    /**
+     * @throws std::invalid_argument - If the list is infinite.
+     */
+    List reverse() const;
+
+    /**
+     * @returns - The numbers of the list in ascending order.
+     *
+     * @throws std::invalid_argument - If the list is infinite or not all of its elements are numbers.
+     */
+    List sort() const;
+
+    /**
+     * @returns - The list without the elements equal to an earlier one, so each
+     *            element appears once, where it first appeared. The numbers are
+     *            compared in sorted order, other elements with each kept one.
+     *
+     * @throws std::invalid_argument - If the list is infinite.
+     */
+    List unique() const;
+
+    /**
+     * @returns - The index of the first element equal to @p value, -1 if there is none.
+     *
+     * @throws std::invalid_argument - If the list is infinite.
+     */
+    int index_of(const Literal& value) const;
+
+    /**
+     * @returns - The index of an element equal to @p value in the list
+     *            sorted in ascending order, -1 if there is none.
+     *
+     * @throws std::invalid_argument - If the list is infinite or not all of its elements are numbers.
+     */
+    int binary_search(double value) const;
+
+    /**
+     * @returns - Whether this list is the only one referring to its numbers,
+     *            so the operations below modify them instead of copying them.
+     *            Lists of other elements, interned lists and concatenations are never reusable.
+     */
+    bool is_reusable() const;
+
+    /**
+     * @brief - tail(), slice(), take(), drop(), reverse() and sort() of a reusable
+     *          list, which modify it instead of copying it.
+     *
+     * @returns - Whether the list was modified, false if it is not reusable
+     *            or the operation would throw, for the caller to copy it instead.
+     */
+    bool tail_in_place();
+    bool slice_in_place(std::size_t begin, std::size_t end);
+    bool take_in_place(std::size_t n);
+    bool drop_in_place(std::size_t n);
+    bool reverse_in_place();
+    bool sort_in_place();
+
+    /**
+     * @returns - The numbers of a reusable list, to write the result of an element-wise
+     *            operation to, which continues an infinite list by @p step.
+     */
+    std::span<double> numbers_in_place(double step);
+
+    /**
+     * @returns - Whether @p a and @p b are equal when numbers are
+     *            taken as lists of one element, without copying them.
+     */
+    static bool equal(const Literal& a, const Literal& b);
 };
 
 
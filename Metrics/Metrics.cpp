@@ -0,0 +1,223 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief - The shards of the running threads, the counts of the exited
+ *          ones and the names of the built in functions.
+ *          Intentionally never destroyed, threads may exit after main().
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<const void*> shards;
+    Metrics::Snapshot retired;
+    std::array<std::string, Metrics::MAX_BUILTINS> builtin_names;
+};
+
+Registry& registry()
+{
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+}
+
+Metrics::Shard::Shard()
+{
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    r.shards.push_back(this);
+}
+
+Metrics::Shard::~Shard()
+{
+    fold_literals();
+
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    add_to(r.retired);
+    r.shards.erase(std::find(r.shards.begin(), r.shards.end(), this));
+}
+
+void Metrics::Shard::add_to(Snapshot& snapshot) const
+{
+    auto get = [](const counter& c) { return c.load(std::memory_order_relaxed); };
+
+    snapshot.evaluations += get(evaluations);
+    snapshot.failed_evaluations += get(failed_evaluations);
+    snapshot.user_calls += get(user_calls);
+    snapshot.literals_allocated += get(literals_allocated);
+    snapshot.literals_freed += get(literals_freed);
+    snapshot.list_nodes_copied += get(list_nodes_copied);
+    snapshot.lists_reused += get(lists_reused);
+    snapshot.peak_depth = std::max(snapshot.peak_depth, get(peak_depth));
+    snapshot.latency_sum_seconds += (double) get(latency_sum_ns) / 1e9;
+
+    if (snapshot.builtin_calls.size() < MAX_BUILTINS)
+        snapshot.builtin_calls.resize(MAX_BUILTINS);
+    for (std::size_t i = 0; i < MAX_BUILTINS; ++i)
+        snapshot.builtin_calls[i].second += get(builtin_calls[i]);
+
+    for (std::size_t i = 0; i < latency_buckets.size(); ++i)
+        snapshot.latency_buckets[i] += get(latency_buckets[i]);
+}
+
+Metrics::EvaluationTimer::~EvaluationTimer()
+{
+    Metrics::count_evaluation(std::chrono::steady_clock::now() - start, !succeeded);
+}
+
+void Metrics::EvaluationTimer::succeed()
+{
+    succeeded = true;
+}
+
+void Metrics::name_builtin(std::size_t opcode, const std::string& name)
+{
+    if (opcode >= MAX_BUILTINS)
+        throw std::out_of_range("Metrics :: Too many built in functions, increase MAX_BUILTINS.");
+
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    r.builtin_names[opcode] = name;
+}
+
+void Metrics::fold_literals()
+{
+    shard.literals_allocated.store(local_literals_allocated, std::memory_order_relaxed);
+    shard.literals_freed.store(local_literals_freed, std::memory_order_relaxed);
+}
+
+void Metrics::count_evaluation(std::chrono::nanoseconds latency, bool failed)
+{
+    fold_literals();
+    add(shard.evaluations);
+    if (failed)
+        add(shard.failed_evaluations);
+
+    add(shard.latency_sum_ns, latency.count());
+
+    double seconds = (double) latency.count() / 1e9;
+    std::size_t bucket = std::lower_bound(LATENCY_BUCKETS.begin(), LATENCY_BUCKETS.end(), seconds) - LATENCY_BUCKETS.begin();
+    add(shard.latency_buckets[bucket]);
+}
+
+Metrics::Snapshot Metrics::snapshot()
+{
+    /// Makes sure the calling thread's shard is registered and up to date.
+    fold_literals();
+
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+
+    Snapshot result = r.retired;
+    for (const void* s : r.shards)
+        static_cast<const Shard*>(s)->add_to(result);
+
+    if (result.builtin_calls.size() < MAX_BUILTINS)
+        result.builtin_calls.resize(MAX_BUILTINS);
+
+    for (std::size_t i = 0; i < MAX_BUILTINS; ++i)
+        result.builtin_calls[i].first = r.builtin_names[i];
+
+    /// Only the functions which exist.
+    std::erase_if(result.builtin_calls, [](const auto& call) { return call.first.empty(); });
+    std::sort(result.builtin_calls.begin(), result.builtin_calls.end());
+
+    return result;
+}
+
+void Metrics::write_table(std::ostream& os)
+{
+    Snapshot s = snapshot();
+
+    os << "evaluations:        " << s.evaluations << " (" << s.failed_evaluations << " failed)\n";
+    os << "user calls:         " << s.user_calls << '\n';
+    os << "peak call depth:    " << s.peak_depth << '\n';
+    os << "literals allocated: " << s.literals_allocated << '\n';
+    os << "literals freed:     " << s.literals_freed << '\n';
+    os << "list nodes copied:  " << s.list_nodes_copied << '\n';
+    os << "lists reused:       " << s.lists_reused << '\n';
+
+    os << "builtin calls:\n";
+    for (const auto&[name, calls] : s.builtin_calls)
+        if (calls)
+            os << "    " << std::left << std::setw(8) << name << std::right << ' ' << calls << '\n';
+
+    os << "evaluation latency:\n";
+    for (std::size_t i = 0; i < s.latency_buckets.size(); ++i) {
+        os << "    ";
+        if (i < LATENCY_BUCKETS.size())
+            os << "<= " << std::left << std::setw(8) << LATENCY_BUCKETS[i] << std::right;
+        else
+            os << ">  " << std::left << std::setw(8) << LATENCY_BUCKETS.back() << std::right;
+        os << "s " << s.latency_buckets[i] << '\n';
+    }
+}
+
+void Metrics::write_prometheus(std::ostream& os)
+{
+    Snapshot s = snapshot();
+
+    auto counter_metric = [&](const char* name, const char* help, std::uint64_t value) {
+        os << "# HELP " << name << ' ' << help << '\n';
+        os << "# TYPE " << name << " counter\n";
+        os << name << ' ' << value << '\n';
+    };
+
+    counter_metric("fli_evaluations_total", "Top-level evaluations.", s.evaluations);
+    counter_metric("fli_evaluation_failures_total", "Top-level evaluations which failed.", s.failed_evaluations);
+    counter_metric("fli_user_calls_total", "Calls of user defined functions.", s.user_calls);
+    counter_metric("fli_literals_allocated_total", "Literals allocated.", s.literals_allocated);
+    counter_metric("fli_literals_freed_total", "Literals freed.", s.literals_freed);
+    counter_metric("fli_list_nodes_copied_total", "List nodes copied.", s.list_nodes_copied);
+    counter_metric("fli_lists_reused_total", "Lists modified in place instead of copied.", s.lists_reused);
+
+    os << "# HELP fli_peak_call_depth Deepest nesting of user defined function calls.\n";
+    os << "# TYPE fli_peak_call_depth gauge\n";
+    os << "fli_peak_call_depth " << s.peak_depth << '\n';
+
+    os << "# HELP fli_builtin_calls_total Calls of built in functions.\n";
+    os << "# TYPE fli_builtin_calls_total counter\n";
+    for (const auto&[name, calls] : s.builtin_calls) {
+        os << "fli_builtin_calls_total{function=\"";
+        for (char c : name)
+            os << (c == '"' || c == '\\' ? "\\" : "") << c;
+        os << "\"} " << calls << '\n';
+    }
+
+    os << "# HELP fli_evaluation_duration_seconds Latency of top-level evaluations.\n";
+    os << "# TYPE fli_evaluation_duration_seconds histogram\n";
+
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < LATENCY_BUCKETS.size(); ++i) {
+        cumulative += s.latency_buckets[i];
+        os << "fli_evaluation_duration_seconds_bucket{le=\"" << LATENCY_BUCKETS[i] << "\"} " << cumulative << '\n';
+    }
+    cumulative += s.latency_buckets.back();
+    os << "fli_evaluation_duration_seconds_bucket{le=\"+Inf\"} " << cumulative << '\n';
+    os << "fli_evaluation_duration_seconds_sum " << s.latency_sum_seconds << '\n';
+    os << "fli_evaluation_duration_seconds_count " << s.evaluations << '\n';
+}
+
+void Metrics::write_prometheus_file(const std::string& path)
+{
+    std::string temporary = path + ".tmp";
+
+    {
+        std::ofstream ofs(temporary);
+        write_prometheus(ofs);
+        if (!ofs)
+            throw std::runtime_error("Metrics :: Cannot write " + temporary);
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Metrics :: Cannot replace " + path);
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief - Counters of the interpreter, always on and process wide:
+ *              - Top-level evaluations and a histogram of their latency.
+ *              - User function calls and built in function calls per function.
+ *              - Literals allocated and freed, list nodes copied, lists reused.
+ *              - The deepest nesting of user function calls.
+ *
+ *          Every thread counts into its own counters, without locking or
+ *          atomic read-modify-writes; a snapshot sums the counters of all
+ *          threads, including the ones which already exited.
+ *          The literals, allocated too often for even that, are counted in
+ *          plain thread local integers which are folded into the thread's
+ *          counters when an evaluation ends, when the thread takes a snapshot
+ *          and when it exits.
+ */
+class Metrics {
+public:
+    static constexpr std::size_t MAX_BUILTINS = 64;
+
+    /// Upper bounds of the latency histogram buckets, in seconds.
+    static constexpr std::array<double, 8> LATENCY_BUCKETS{1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1, 10, 100};
+
+    struct Snapshot {
+        std::uint64_t evaluations = 0;
+        std::uint64_t failed_evaluations = 0;
+        std::uint64_t user_calls = 0;
+        std::uint64_t literals_allocated = 0;
+        std::uint64_t literals_freed = 0;
+        std::uint64_t list_nodes_copied = 0;
+        std::uint64_t lists_reused = 0;
+        std::uint64_t peak_depth = 0;
+
+        /// Calls of each built in function, by name.
+        std::vector<std::pair<std::string, std::uint64_t>> builtin_calls;
+
+        /// Evaluations per latency bucket, the last one is +Inf. Not cumulative.
+        std::array<std::uint64_t, LATENCY_BUCKETS.size() + 1> latency_buckets{};
+        double latency_sum_seconds = 0;
+    };
+
+    /**
+     * @brief - Counts a top-level evaluation, from its construction to its destruction.
+     */
+    class EvaluationTimer {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool succeeded = false;
+
+    public:
+        EvaluationTimer() = default;
+        ~EvaluationTimer();
+
+        EvaluationTimer(const EvaluationTimer&) = delete;
+        EvaluationTimer& operator=(const EvaluationTimer&) = delete;
+
+        /**
+         * @brief - Marks the evaluation as successful, it is counted as failed otherwise.
+         */
+        void succeed();
+    };
+
+private:
+    using counter = std::atomic<std::uint64_t>;
+
+    /// The counters of a single thread, written only by it.
+    struct Shard {
+        counter evaluations{0};
+        counter failed_evaluations{0};
+        counter user_calls{0};
+        counter literals_allocated{0};
+        counter literals_freed{0};
+        counter list_nodes_copied{0};
+        counter lists_reused{0};
+        counter peak_depth{0};
+        counter latency_sum_ns{0};
+        std::array<counter, MAX_BUILTINS> builtin_calls{};
+        std::array<counter, LATENCY_BUCKETS.size() + 1> latency_buckets{};
+
+        Shard();
+        ~Shard();
+
+        void add_to(Snapshot& snapshot) const;
+    };
+
+    static inline thread_local Shard shard{};
+
+    /// Trivial thread locals, cheaper to reach than the shard.
+    static inline thread_local std::uint64_t local_literals_allocated = 0;
+    static inline thread_local std::uint64_t local_literals_freed = 0;
+
+    /**
+     * @brief - Publishes the literals counted by the calling thread.
+     */
+    static void fold_literals();
+
+    static void add(counter& c, std::uint64_t n = 1)
+    {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+    /**
+     * @brief - Names the built in function counted as @p opcode.
+     */
+    static void name_builtin(std::size_t opcode, const std::string& name);
+
+    static void count_evaluation(std::chrono::nanoseconds latency, bool failed);
+
+    static void count_user_call()
+    {
+        add(shard.user_calls);
+    }
+
+    static void count_builtin_call(std::size_t opcode)
+    {
+        if (opcode < MAX_BUILTINS)
+            add(shard.builtin_calls[opcode]);
+    }
+
+    static void count_literal_allocated()
+    {
+        ++local_literals_allocated;
+    }
+
+    static void count_literal_freed()
+    {
+        ++local_literals_freed;
+    }
+
+    static void count_list_nodes_copied(std::size_t nodes)
+    {
+        add(shard.list_nodes_copied, nodes);
+    }
+
+    static void count_list_reused()
+    {
+        add(shard.lists_reused);
+    }
+
+    static void record_depth(std::size_t depth)
+    {
+        if (depth > shard.peak_depth.load(std::memory_order_relaxed))
+            shard.peak_depth.store(depth, std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns - The counters summed over all threads.
+     */
+    static Snapshot snapshot();
+
+    /**
+     * @brief - Writes a snapshot for humans, used by the :stats command.
+     */
+    static void write_table(std::ostream& os);
+
+    /**
+     * @brief - Writes a snapshot in the Prometheus text exposition format.
+     */
+    static void write_prometheus(std::ostream& os);
+
+    /**
+     * @brief - Replaces the file at @p path with a snapshot in the
+     *          Prometheus text format, atomically for its readers.
+     *
+     * @throws std::runtime_error - If the file cannot be written.
+     */
+    static void write_prometheus_file(const std::string& path);
+};
@@ -0,0 +1,328 @@
+#include "NumericKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <latch>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FLI_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Operation = NumericKernels::Operation;
+
+/// Which operands are arrays, the other one is a single number.
+enum class Operands {
+    BOTH,
+    LEFT,
+    RIGHT
+};
+
+template<Operation op>
+double scalar(double a, double b)
+{
+    if constexpr (op == Operation::ADD)
+        return a + b;
+    else if constexpr (op == Operation::SUB)
+        return a - b;
+    else if constexpr (op == Operation::MUL)
+        return a * b;
+    else if constexpr (op == Operation::DIV)
+        return a / b;
+    else
+        return a < b ? 1.0 : 0.0;
+}
+
+template<Operation op, Operands operands>
+void loop(const double* a, const double* b, double* out, std::size_t n, std::size_t i = 0)
+{
+    for (; i < n; ++i) {
+        double x = operands == Operands::RIGHT ? *a : a[i];
+        double y = operands == Operands::LEFT ? *b : b[i];
+        out[i] = scalar<op>(x, y);
+    }
+}
+
+#ifdef FLI_AVX2
+
+bool has_avx2()
+{
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+template<Operation op>
+__attribute__((target("avx2"))) __m256d vector(__m256d a, __m256d b)
+{
+    if constexpr (op == Operation::ADD)
+        return _mm256_add_pd(a, b);
+    else if constexpr (op == Operation::SUB)
+        return _mm256_sub_pd(a, b);
+    else if constexpr (op == Operation::MUL)
+        return _mm256_mul_pd(a, b);
+    else if constexpr (op == Operation::DIV)
+        return _mm256_div_pd(a, b);
+    else
+        return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ), _mm256_set1_pd(1.0));
+}
+
+template<Operation op, Operands operands>
+__attribute__((target("avx2"))) void loop_avx2(const double* a, const double* b, double* out, std::size_t n)
+{
+    std::size_t i = 0;
+
+    if (n >= 4) {
+        __m256d number = _mm256_set1_pd(operands == Operands::RIGHT ? *a : operands == Operands::LEFT ? *b : 0.0);
+
+        for (; i + 4 <= n; i += 4) {
+            __m256d x = operands == Operands::RIGHT ? number : _mm256_loadu_pd(a + i);
+            __m256d y = operands == Operands::LEFT ? number : _mm256_loadu_pd(b + i);
+            _mm256_storeu_pd(out + i, vector<op>(x, y));
+        }
+    }
+
+    loop<op, operands>(a, b, out, n, i);
+}
+
+__attribute__((target("avx2"))) void sqrt_avx2(const double* a, double* out, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(a + i)));
+
+    for (; i < n; ++i)
+        out[i] = std::sqrt(a[i]);
+}
+
+__attribute__((target("avx2"))) void floor_avx2(const double* a, double* out, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_floor_pd(_mm256_loadu_pd(a + i)));
+
+    for (; i < n; ++i)
+        out[i] = std::floor(a[i]);
+}
+
+__attribute__((target("avx2"))) double sum_avx2(const double* a, std::size_t n)
+{
+    std::size_t i = 0;
+    __m256d sum = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4)
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(a + i));
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+
+    double result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i)
+        result += a[i];
+
+    return result;
+}
+
+__attribute__((target("avx2"))) bool equal_avx2(const double* a, const double* b, std::size_t n, double tolerance)
+{
+    std::size_t i = 0;
+    __m256d limit = _mm256_set1_pd(tolerance);
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d differ = _mm256_setzero_pd();
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d difference = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        /// Not less than, true for NaN like the scalar comparison.
+        differ = _mm256_or_pd(differ, _mm256_cmp_pd(difference, limit, _CMP_NLT_UQ));
+    }
+
+    bool result = _mm256_movemask_pd(differ) == 0;
+    for (; i < n; ++i)
+        result &= std::abs(a[i] - b[i]) < tolerance;
+
+    return result;
+}
+
+#endif
+
+template<Operation op, Operands operands>
+void run(const double* a, const double* b, double* out, std::size_t n)
+{
+#ifdef FLI_AVX2
+    if (has_avx2())
+        return loop_avx2<op, operands>(a, b, out, n);
+#endif
+
+    loop<op, operands>(a, b, out, n);
+}
+
+template<Operands operands>
+void dispatch(Operation op, const double* a, const double* b, double* out, std::size_t n)
+{
+    switch (op) {
+        case Operation::ADD:  return run<Operation::ADD, operands>(a, b, out, n);
+        case Operation::SUB:  return run<Operation::SUB, operands>(a, b, out, n);
+        case Operation::MUL:  return run<Operation::MUL, operands>(a, b, out, n);
+        case Operation::DIV:  return run<Operation::DIV, operands>(a, b, out, n);
+        case Operation::LESS: return run<Operation::LESS, operands>(a, b, out, n);
+    }
+}
+
+}
+
+void NumericKernels::apply(Operation op, std::span<const double> a, std::span<const double> b, std::span<double> out)
+{
+    assert(a.size() == b.size() && a.size() == out.size());
+    dispatch<Operands::BOTH>(op, a.data(), b.data(), out.data(), out.size());
+}
+
+void NumericKernels::apply(Operation op, std::span<const double> a, double b, std::span<double> out)
+{
+    assert(a.size() == out.size());
+    dispatch<Operands::LEFT>(op, a.data(), &b, out.data(), out.size());
+}
+
+void NumericKernels::apply(Operation op, double a, std::span<const double> b, std::span<double> out)
+{
+    assert(b.size() == out.size());
+    dispatch<Operands::RIGHT>(op, &a, b.data(), out.data(), out.size());
+}
+
+void NumericKernels::sqrt(std::span<const double> a, std::span<double> out)
+{
+    assert(a.size() == out.size());
+
+#ifdef FLI_AVX2
+    if (has_avx2())
+        return sqrt_avx2(a.data(), out.data(), out.size());
+#endif
+
+    for (std::size_t i = 0; i < out.size(); ++i)
+        out[i] = std::sqrt(a[i]);
+}
+
+void NumericKernels::floor(std::span<const double> a, std::span<double> out)
+{
+    assert(a.size() == out.size());
+
+#ifdef FLI_AVX2
+    if (has_avx2())
+        return floor_avx2(a.data(), out.data(), out.size());
+#endif
+
+    for (std::size_t i = 0; i < out.size(); ++i)
+        out[i] = std::floor(a[i]);
+}
+
+double NumericKernels::sum(std::span<const double> a)
+{
+#ifdef FLI_AVX2
+    if (has_avx2())
+        return sum_avx2(a.data(), a.size());
+#endif
+
+    double result = 0;
+    for (double number : a)
+        result += number;
+
+    return result;
+}
+
+void NumericKernels::sort(std::span<double> a)
+{
+    /// NaNs are not ordered, so they are moved out of the way of std::sort.
+    auto nan = std::partition(a.begin(), a.end(), [](double number) { return !std::isnan(number); });
+    std::span<double> numbers(a.begin(), nan);
+
+    std::size_t parts = std::min<std::size_t>(std::thread::hardware_concurrency(),
+                                              numbers.size() / PARALLEL_SORT_SIZE);
+
+    /// Shared by all the sorts, the thread calling sort() works on a part too.
+    /// If its threads cannot be started the numbers are sorted on this thread.
+    ThreadPool* pool = parts < 2 ? nullptr : sort_pool();
+    if (!pool) {
+        std::sort(numbers.begin(), numbers.end());
+        return;
+    }
+
+    std::vector<std::size_t> bounds;
+    for (std::size_t k = 0; k <= parts; ++k)
+        bounds.push_back(numbers.size() * k / parts);
+
+    /// Runs f(k) for every k < n, the first one on this thread.
+    auto parallel = [pool](std::size_t n, auto f) {
+        std::latch done((std::ptrdiff_t) n - 1);
+        for (std::size_t k = 1; k < n; ++k) {
+            try {
+                pool->submit([&done, &f, k] {
+                    f(k);
+                    done.count_down();
+                });
+            } catch (...) {
+                /// The submitted parts still use f.
+                done.count_down((std::ptrdiff_t) (n - k));
+                done.wait();
+                throw;
+            }
+        }
+        f(0);
+        done.wait();
+    };
+
+    parallel(parts, [&](std::size_t k) {
+        std::sort(numbers.begin() + bounds[k], numbers.begin() + bounds[k + 1]);
+    });
+
+    for (std::size_t width = 1; width < parts; width *= 2) {
+        parallel((parts + 2 * width - 1) / (2 * width), [&](std::size_t k) {
+            std::size_t first = 2 * width * k;
+            if (first + width < parts) {
+                std::inplace_merge(numbers.begin() + bounds[first],
+                                   numbers.begin() + bounds[first + width],
+                                   numbers.begin() + bounds[std::min(first + 2 * width, parts)]);
+            }
+        });
+    }
+}
+
+ThreadPool* NumericKernels::sort_pool()
+{
+    try {
+        static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+        return &pool;
+    } catch (const std::system_error&) {
+        return nullptr;
+    }
+}
+
+bool NumericKernels::equal(std::span<const double> a, std::span<const double> b, double tolerance)
+{
+    assert(a.size() == b.size());
+
+#ifdef FLI_AVX2
+    if (has_avx2())
+        return equal_avx2(a.data(), b.data(), a.size(), tolerance);
+#endif
+
+    /// Without branches, so the compiler may vectorize it.
+    bool result = true;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        result &= std::abs(a[i] - b[i]) < tolerance;
+
+    return result;
+}
+
+bool NumericKernels::is_vectorized()
+{
+#ifdef FLI_AVX2
+    return has_avx2();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+class ThreadPool;
+
+/**
+ * @brief - Loops over arrays of numbers, the storage of lists of numbers.
+ *
+ *          On x86 processors supporting AVX2 they process four numbers
+ *          per instruction, chosen at run time, elsewhere they are plain
+ *          loops the compiler may vectorize.
+ *          The output may be one of the inputs, the inputs and the output
+ *          must have the same size.
+ */
+class NumericKernels {
+public:
+    enum class Operation {
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+
+        /// 1 if the left number is less than the right one, 0 otherwise.
+        LESS
+    };
+
+    static void apply(Operation op, std::span<const double> a, std::span<const double> b, std::span<double> out);
+    static void apply(Operation op, std::span<const double> a, double b, std::span<double> out);
+    static void apply(Operation op, double a, std::span<const double> b, std::span<double> out);
+
+    static void sqrt(std::span<const double> a, std::span<double> out);
+    static void floor(std::span<const double> a, std::span<double> out);
+
+    static double sum(std::span<const double> a);
+
+    /**
+     * @brief - Sorts @p a in ascending order, with the NaNs last.
+     *          Arrays of at least PARALLEL_SORT_SIZE numbers are split between
+     *          the calling thread and the workers of a pool shared by all the
+     *          sorts, which sort their parts and merge them.
+     */
+    static void sort(std::span<double> a);
+    static constexpr std::size_t PARALLEL_SORT_SIZE = 1 << 16;
+
+private:
+    /**
+     * @returns - The pool of the sorts, started on the first call,
+     *            nullptr if its threads could not be started.
+     */
+    static ThreadPool* sort_pool();
+
+public:
+
+    /**
+     * @returns - Whether every two numbers at the same position differ by less than @p tolerance.
+     */
+    static bool equal(std::span<const double> a, std::span<const double> b, double tolerance);
+
+    /**
+     * @returns - Whether the vectorized versions are used.
+     */
+    static bool is_vectorized();
+};
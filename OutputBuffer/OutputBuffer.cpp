@@ -0,0 +1,231 @@
+#include "OutputBuffer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BigInteger.h"
+#include "Literal.h"
+
+OutputBuffer::OutputBuffer(std::ostream& os, std::size_t capacity)
+        : os(&os),
+          capacity(std::max(capacity, MAX_NUMBER_LENGTH))
+{}
+
+OutputBuffer::~OutputBuffer()
+{
+    flush();
+}
+
+void OutputBuffer::set_precision(int precision)
+{
+    if (precision < 0 || precision > MAX_PRECISION)
+        throw std::invalid_argument("OutputBuffer :: set_precision() -> Expected 0 to " + std::to_string(MAX_PRECISION)
+                                    + " digits, given " + std::to_string(precision) + ".");
+
+    this->precision = precision;
+}
+
+char* OutputBuffer::reserve(std::size_t n)
+{
+    if (!buffer)
+        buffer = std::make_unique<char[]>(capacity);
+
+    if (used + n > capacity)
+        flush();
+
+    return buffer.get() + used;
+}
+
+void OutputBuffer::flush()
+{
+    if (used == 0)
+        return;
+
+    os->write(buffer.get(), (std::streamsize) used);
+    flushed += used;
+    used = 0;
+}
+
+void OutputBuffer::write(char c)
+{
+    *reserve(1) = c;
+    ++used;
+}
+
+void OutputBuffer::write(std::string_view text)
+{
+    if (text.size() > capacity) {
+        flush();
+        os->write(text.data(), (std::streamsize) text.size());
+        flushed += text.size();
+        return;
+    }
+
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+    used += text.size();
+}
+
+void OutputBuffer::write(std::int64_t number)
+{
+    char* out = reserve(MAX_NUMBER_LENGTH);
+    used += std::to_chars(out, out + MAX_NUMBER_LENGTH, number).ptr - out;
+}
+
+void OutputBuffer::write(double number)
+{
+    char* out = reserve(MAX_NUMBER_LENGTH);
+    std::to_chars_result result = precision == SHORTEST
+            ? std::to_chars(out, out + MAX_NUMBER_LENGTH, number)
+            : std::to_chars(out, out + MAX_NUMBER_LENGTH, number, std::chars_format::general, precision);
+
+    used += result.ptr - out;
+}
+
+void OutputBuffer::write(const BigInteger& number)
+{
+    if (number.is_small())
+        write(number.get_small());
+    else
+        write(number.to_string());
+}
+
+void OutputBuffer::write_json_number(double number)
+{
+    if (!std::isfinite(number)) {
+        write("null");
+        return;
+    }
+
+    char* out = reserve(MAX_NUMBER_LENGTH);
+    used += std::to_chars(out, out + MAX_NUMBER_LENGTH, number).ptr - out;
+}
+
+void OutputBuffer::write_json(std::string_view text)
+{
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    write('"');
+    for (char c : text) {
+        switch (c) {
+            case '"':  write("\\\""); break;
+            case '\\': write("\\\\"); break;
+            case '\n': write("\\n"); break;
+            case '\r': write("\\r"); break;
+            case '\t': write("\\t"); break;
+            default:
+                if ((unsigned char) c < 0x20) {
+                    write("\\u00");
+                    write(HEX_DIGITS[c >> 4]);
+                    write(HEX_DIGITS[c & 0xf]);
+                } else {
+                    write(c);
+                }
+        }
+    }
+    write('"');
+}
+
+void OutputBuffer::write(const Literal& literal)
+{
+    write_literal(literal, false);
+}
+
+void OutputBuffer::write(const Literal& literal, std::size_t max_length)
+{
+    write_literal(literal, false, max_length);
+}
+
+void OutputBuffer::write_json(const Literal& literal)
+{
+    write_literal(literal, true);
+}
+
+void OutputBuffer::write_literal(const Literal& literal, bool json, std::size_t max_length)
+{
+    char separator = json ? ',' : ' ';
+    std::size_t limit = max_length == SIZE_MAX ? SIZE_MAX : size() + max_length;
+
+    /// An infinite list is a JSON object with the elements generated so far.
+    auto end = [&](bool infinite) {
+        write(!infinite ? "]" : json ? "]}" : " ...]");
+    };
+
+    auto number = [&](double x) {
+        if (json)
+            write_json_number(x);
+        else
+            write(x);
+    };
+
+    /// The lists of other elements being written, the next
+    /// of their elements and whether they are infinite.
+    struct Level {
+        std::span<const Literal::element_type> elements;
+        std::size_t                            next;
+        bool                                   infinite;
+    };
+    std::vector<Level> levels;
+
+    /// Writes a number or the beginning of a list, the elements of a list
+    /// of other elements are written by the loop below.
+    auto begin = [&](const Literal& element) {
+        if (element.get_type() == LITERAL_TYPE::DOUBLE) {
+            number(element.get_double());
+            return;
+        }
+        if (element.get_type() == LITERAL_TYPE::INTEGER) {
+            write(static_cast<const Integer&>(element).get_integer());
+            return;
+        }
+
+        const List::Node& node = *static_cast<const List&>(element).node;
+        bool infinite = node.max_size == -1;
+
+        if (infinite && json) {
+            write("{\"infinite\":true,\"step\":");
+            number(node.step);
+            write(",\"first\":");
+        }
+
+        if (node.size() == 0) {
+            write(infinite && json ? "[]}" : "[]");
+        } else if (node.is_numeric()) {
+            std::span<const double> numbers = node.numbers();
+
+            write('[');
+            number(numbers[0]);
+            for (std::size_t i = 1; i < numbers.size(); ++i) {
+                if (size() >= limit)
+                    return;
+                write(separator);
+                number(numbers[i]);
+            }
+            end(infinite);
+        } else {
+            write('[');
+            levels.push_back({node.elements(), 0, infinite});
+        }
+    };
+
+    begin(literal);
+
+    while (!levels.empty() && size() < limit) {
+        Level& level = levels.back();
+
+        if (level.next == level.elements.size()) {
+            end(level.infinite);
+            levels.pop_back();
+            continue;
+        }
+
+        if (level.next != 0)
+            write(separator);
+        begin(*level.elements[level.next++]);
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+class BigInteger;
+class Literal;
+
+/**
+ * @brief - Text written to a stream in large blocks.
+ *
+ *          The literals are formatted by std::to_chars straight into the
+ *          buffer, which is reused for every write and only handed to the
+ *          stream when it is full or flush() is called (at the latest by the
+ *          destructor). Nested lists are traversed with an explicit stack,
+ *          so printing a deeply nested list does not overflow the call stack.
+ *          The literals can also be written as JSON, for the NDJSON output.
+ */
+class OutputBuffer {
+public:
+    /// Bytes buffered before they are written to the stream.
+    static constexpr std::size_t BLOCK_SIZE = 1 << 16;
+
+    /// Numbers are printed with the fewest digits which read back as the same double.
+    static constexpr int SHORTEST = 0;
+
+    /// Significant digits of the numbers by default, as printed by std::ostream.
+    static constexpr int DEFAULT_PRECISION = 6;
+
+    /// The most significant digits a double has.
+    static constexpr int MAX_PRECISION = 17;
+
+private:
+    /// Enough for any number formatted with at most MAX_PRECISION digits.
+    static constexpr std::size_t MAX_NUMBER_LENGTH = 32;
+
+    std::ostream*           os;
+    std::unique_ptr<char[]> buffer;
+    std::size_t             capacity;
+    std::size_t             used = 0;
+    std::size_t             flushed = 0;    /// Bytes handed to the stream so far.
+    int                     precision = DEFAULT_PRECISION;
+
+    /**
+     * @returns - Space for @p n more bytes, flushing the buffer if needed.
+     */
+    char* reserve(std::size_t n);
+
+    /**
+     * @brief - Writes @p literal as text or, when @p json, as a JSON value,
+     *          stopping after the number which reaches @p max_length bytes.
+     */
+    void write_literal(const Literal& literal, bool json, std::size_t max_length = SIZE_MAX);
+    void write_json_number(double number);
+
+public:
+    /**
+     * @param capacity - The size of the buffer, allocated on the first write.
+     */
+    explicit OutputBuffer(std::ostream& os, std::size_t capacity = BLOCK_SIZE);
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    ~OutputBuffer();
+
+    std::ostream& get_stream()
+    {
+        return *os;
+    }
+
+    int get_precision() const
+    {
+        return precision;
+    }
+
+    /**
+     * @brief - Sets the significant digits of the numbers printed from now on,
+     *          SHORTEST for the shortest round-trip representation.
+     *
+     * @throws std::invalid_argument - If @p precision is negative or above MAX_PRECISION.
+     */
+    void set_precision(int precision);
+
+    void write(char c);
+    void write(std::string_view text);
+
+    void write(std::int64_t number);
+    void write(double number);
+    void write(const BigInteger& number);
+
+    /**
+     * @brief - Writes @p literal as the interpreter prints it:
+     *          "[1 [2 3] 4]", and "[1 2 3 ...]" for an infinite list.
+     */
+    void write(const Literal& literal);
+
+    /**
+     * @brief - Writes the beginning of @p literal, up to the number which
+     *          reaches @p max_length bytes, the rest is not even formatted.
+     */
+    void write(const Literal& literal, std::size_t max_length);
+
+    /**
+     * @brief - Writes @p literal as a JSON number or array of the same nesting.
+     *          The numbers are written with the shortest round-trip representation,
+     *          whatever the precision, and infinite or NaN as null.
+     *          An infinite list is written as an object with its step and
+     *          the elements generated so far: {"infinite":true,"step":1,"first":[1,2]}.
+     */
+    void write_json(const Literal& literal);
+
+    /**
+     * @brief - Writes @p text as a quoted JSON string.
+     */
+    void write_json(std::string_view text);
+
+    /**
+     * @brief - Writes the buffered text to the stream.
+     */
+    void flush();
+
+    /**
+     * @returns - The number of bytes buffered and not yet written to the stream.
+     */
+    std::size_t pending() const
+    {
+        return used;
+    }
+
+    /**
+     * @returns - The number of bytes written, flushed or not.
+     */
+    std::size_t size() const
+    {
+        return flushed + used;
+    }
+};
+
+template<typename T>
+OutputBuffer& operator<<(OutputBuffer& buffer, const T& value)
+    requires requires { buffer.write(value); }
+{
+    buffer.write(value);
+    return buffer;
+}
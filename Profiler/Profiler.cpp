@@ -0,0 +1,143 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "Literal.h"
+
+Profiler::Scope::Scope(Profiler* profiler, const std::string& name)
+        : profiler(profiler)
+{
+    if (profiler)
+        profiler->enter(name);
+}
+
+Profiler::Scope::~Scope()
+{
+    if (profiler)
+        profiler->leave();
+}
+
+void Profiler::enter(const std::string& name)
+{
+    Totals* function = &functions[name];
+    if (function->profile.name.empty())
+        function->profile.name = name;
+
+    std::size_t parent = frames.empty() ? ROOT : frames.back().node;
+    std::size_t node = parent;
+
+    if (stacks[parent].function != function && frames.size() < MAX_STACK_DEPTH) {
+        auto it = stacks[parent].children.find(function);
+        if (it == stacks[parent].children.end()) {
+            stacks.push_back(StackNode{parent, function});
+            it = stacks[parent].children.emplace(function, stacks.size() - 1).first;
+        }
+        node = it->second;
+    }
+
+    ++function->active;
+    frames.push_back(Frame{function, node, clock::now(), std::chrono::nanoseconds(0),
+                           Literal::allocation_count(), Literal::allocated_bytes()});
+}
+
+void Profiler::leave()
+{
+    if (frames.empty())
+        return;
+
+    Frame frame = frames.back();
+    frames.pop_back();
+
+    auto inclusive = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - frame.start);
+    auto exclusive = inclusive - frame.children;
+    std::size_t allocations = Literal::allocation_count() - frame.allocations;
+    std::size_t bytes = Literal::allocated_bytes() - frame.bytes;
+
+    FunctionProfile& profile = frame.function->profile;
+    ++profile.calls;
+    profile.exclusive += exclusive;
+    profile.allocations += allocations - frame.child_allocations;
+    profile.bytes += bytes - frame.child_bytes;
+
+    /// Recursive calls are already counted in the outermost one.
+    if (--frame.function->active == 0)
+        profile.inclusive += inclusive;
+
+    stacks[frame.node].exclusive += exclusive;
+
+    if (!frames.empty()) {
+        frames.back().children += inclusive;
+        frames.back().child_allocations += allocations;
+        frames.back().child_bytes += bytes;
+    }
+}
+
+std::vector<Profiler::FunctionProfile> Profiler::get_profiles() const
+{
+    std::vector<FunctionProfile> profiles;
+    profiles.reserve(functions.size());
+
+    for (const auto&[name, totals] : functions)
+        profiles.push_back(totals.profile);
+
+    std::sort(profiles.begin(), profiles.end(), [](const FunctionProfile& a, const FunctionProfile& b) {
+        return a.exclusive > b.exclusive || a.exclusive == b.exclusive && a.name < b.name;
+    });
+
+    return profiles;
+}
+
+void Profiler::write_table(std::ostream& os) const
+{
+    std::vector<FunctionProfile> profiles = get_profiles();
+
+    std::size_t width = 8;
+    for (const FunctionProfile& profile : profiles)
+        width = std::max(width, profile.name.size());
+
+    auto ms = [](std::chrono::nanoseconds time) { return (double) time.count() / 1e6; };
+
+    os << std::left << std::setw((int) width) << "function"
+       << std::right << std::setw(12) << "calls"
+       << std::setw(16) << "inclusive (ms)"
+       << std::setw(16) << "exclusive (ms)"
+       << std::setw(14) << "self allocs"
+       << std::setw(14) << "self bytes" << '\n';
+
+    os << std::fixed << std::setprecision(3);
+    for (const FunctionProfile& profile : profiles) {
+        os << std::left << std::setw((int) width) << profile.name
+           << std::right << std::setw(12) << profile.calls
+           << std::setw(16) << ms(profile.inclusive)
+           << std::setw(16) << ms(profile.exclusive)
+           << std::setw(14) << profile.allocations
+           << std::setw(14) << profile.bytes << '\n';
+    }
+    os << std::defaultfloat;
+}
+
+std::string Profiler::stack_of(std::size_t node) const
+{
+    std::vector<const std::string*> names;
+    for (; node != ROOT; node = stacks[node].parent)
+        names.push_back(&stacks[node].function->profile.name);
+
+    std::string stack;
+    for (auto it = names.rbegin(); it != names.rend(); ++it) {
+        if (!stack.empty())
+            stack.push_back(';');
+        stack += **it;
+    }
+
+    return stack;
+}
+
+void Profiler::write_collapsed_stacks(std::ostream& os) const
+{
+    for (std::size_t node = ROOT + 1; node < stacks.size(); ++node) {
+        auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(stacks[node].exclusive).count();
+        if (microseconds > 0)
+            os << stack_of(node) << ' ' << microseconds << '\n';
+    }
+}
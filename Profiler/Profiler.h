@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief - Collects, per user defined function, the number of calls,
+ *          the time spent in it with (inclusive) and without (exclusive)
+ *          the functions it calls, and the literals it allocates itself.
+ *          Also collects the exclusive time per call stack, for flame graphs.
+ *
+ *          Used by a single thread at a time.
+ */
+class Profiler {
+    using clock = std::chrono::steady_clock;
+
+public:
+    /**
+     * @brief - The totals of a single function.
+     */
+    struct FunctionProfile {
+        std::string              name;
+        std::uint64_t            calls = 0;
+        std::chrono::nanoseconds inclusive{0};
+        std::chrono::nanoseconds exclusive{0};
+        std::uint64_t            allocations = 0;
+        std::uint64_t            bytes = 0;
+    };
+
+    /**
+     * @brief - Profiles a call for as long as it lives.
+     */
+    class Scope {
+        Profiler* profiler;
+
+    public:
+        /**
+         * @param profiler - The profiler, nullptr when not profiling.
+         */
+        Scope(Profiler* profiler, const std::string& name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    /// Deeper calls are attributed to the stack of this depth.
+    static constexpr std::size_t MAX_STACK_DEPTH = 256;
+
+    struct Totals {
+        FunctionProfile profile;
+        std::size_t     active = 0;     /// Number of unfinished calls, for recursion.
+    };
+
+    /// A node of the tree of call stacks, a function called directly
+    /// by itself shares its caller's node.
+    struct StackNode {
+        std::size_t              parent;
+        Totals*                  function;
+        std::chrono::nanoseconds exclusive{0};
+        std::unordered_map<const Totals*, std::size_t> children{};
+    };
+
+    struct Frame {
+        Totals*           function;
+        std::size_t       node;
+        clock::time_point start;
+        std::chrono::nanoseconds children{0};
+        std::size_t       allocations;
+        std::size_t       bytes;
+        std::size_t       child_allocations = 0;
+        std::size_t       child_bytes = 0;
+    };
+
+    static constexpr std::size_t ROOT = 0;
+
+    std::unordered_map<std::string, Totals> functions{};
+    std::vector<StackNode> stacks{StackNode{ROOT, nullptr}};
+    std::vector<Frame> frames{};
+
+private:
+    std::string stack_of(std::size_t node) const;
+
+public:
+    /**
+     * @brief - Starts a call of @p name, inside the current one.
+     */
+    void enter(const std::string& name);
+
+    /**
+     * @brief - Finishes the current call.
+     */
+    void leave();
+
+    /**
+     * @returns - The profiles of the called functions, by descending exclusive time.
+     */
+    std::vector<FunctionProfile> get_profiles() const;
+
+    /**
+     * @brief - Writes the profiles as a table.
+     */
+    void write_table(std::ostream& os) const;
+
+    /**
+     * @brief - Writes one line per call stack, "f;g;h <exclusive microseconds>",
+     *          the format flamegraph.pl and similar tools take.
+     */
+    void write_collapsed_stacks(std::ostream& os) const;
+};
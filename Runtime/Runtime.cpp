@@ -0,0 +1,300 @@
+#include "Runtime.h"
+
+#include <fstream>
+#include <sstream>
+#include <stack>
+#include <stdexcept>
+
+#include "Literal.h"
+#include "SymbolTable.h"
+#include "StackFrame.h"
+#include "FunctionParser.h"
+#include "AllocationTracker.h"
+
+///------------------ARGUMENT--------------------------
+
+Runtime::Argument::Argument(double number)
+        : number(number)
+{}
+
+Runtime::Argument::Argument(std::span<const double> list)
+        : data(list.data()),
+          size(list.size()),
+          list(true)
+{}
+
+Runtime::Argument::Argument(const std::vector<double>& list)
+        : Argument(std::span<const double>(list))
+{}
+
+///------------------VALUE--------------------------
+
+Runtime::Value::Value(std::shared_ptr<const Literal> literal)
+        : literal(std::move(literal))
+{}
+
+bool Runtime::Value::is_number() const
+{
+    return literal->is_number();
+}
+
+bool Runtime::Value::is_list() const
+{
+    return literal->get_type() == LITERAL_TYPE::LIST;
+}
+
+double Runtime::Value::as_number() const
+{
+    return literal->get_double();
+}
+
+int Runtime::Value::size() const
+{
+    return literal->length();
+}
+
+Runtime::Value Runtime::Value::operator[](std::size_t index) const
+{
+    if (!is_list())
+        throw std::invalid_argument("Runtime :: Cannot index a number.");
+
+    const List& list = static_cast<const List&>(*literal);
+
+    if (index >= list.size()) {
+        if (list.length() != -1)
+            throw std::out_of_range("Runtime :: Index out of range: " + std::to_string(index));
+
+        /// Past the generated elements of an infinite list.
+        double last = list.number_at(list.size() - 1);
+        return Value(std::make_shared<Double>(last + list.get_step() * (double) (index - list.size() + 1)));
+    }
+
+    /// The elements are immutable, the value shares the element.
+    return Value(list.at(index));
+}
+
+std::vector<double> Runtime::Value::as_numbers() const
+{
+    if (literal->length() == -1)
+        throw std::invalid_argument("Runtime :: Cannot convert an infinite list to numbers.");
+
+    std::span<const double> numbers = literal->get_numbers();
+    return {numbers.begin(), numbers.end()};
+}
+
+std::string Runtime::Value::to_string() const
+{
+    std::ostringstream os;
+    os << *literal;
+    return os.str();
+}
+
+///------------------FUNCTION--------------------------
+
+std::size_t Runtime::Function::get_arity() const
+{
+    return arity;
+}
+
+///------------------RUNTIME--------------------------
+
+Runtime::Runtime()
+        : symbol_table(std::make_unique<SymbolTable>())
+{}
+
+Runtime::~Runtime() = default;
+
+Runtime::Runtime(Runtime&&) noexcept = default;
+
+Runtime& Runtime::operator=(Runtime&&) noexcept = default;
+
+bool Runtime::define(const std::string& name, const std::string& body)
+{
+    if (name.empty())
+        throw std::invalid_argument("Runtime :: Empty function name.");
+
+    for (char c : name)
+        if (!('a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' || '0' <= c && c <= '9'))
+            throw std::invalid_argument("Runtime :: Invalid function name: " + name);
+
+    check_brackets(body);
+
+    bool defined = symbol_table->contains(name);
+    symbol_table->add_definition(name, std::make_pair((int) count_parameters(body), body));
+
+    return defined;
+}
+
+void Runtime::load(const std::string& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs)
+        throw std::invalid_argument("Runtime :: Cannot open " + path);
+
+    std::istringstream input;
+    std::ostringstream output;
+    EvaluationContext context(input, output);
+    context.set_budget(budget);
+
+    FunctionParser parser(*symbol_table, context);
+
+    while (!ifs.eof())
+        ifs >> parser;
+}
+
+Runtime::Function Runtime::compile(const std::string& expression) const
+{
+    check_brackets(expression);
+
+    Function function;
+    function.body = expression;
+    function.arity = count_parameters(expression);
+
+    std::size_t len = expression.length();
+    std::size_t i = 0;
+
+    auto is_letter = [](char c) { return 'a' <= c && c <= 'z' || 'A' <= c && c <= 'Z'; };
+    auto is_digit = [](char c) { return '0' <= c && c <= '9'; };
+
+    /// Every called function must be known.
+    while (i < len) {
+        if (is_letter(expression[i])) {
+            std::string name;
+            while (i < len && (is_letter(expression[i]) || is_digit(expression[i])))
+                name.push_back(expression[i++]);
+
+            if (i < len && expression[i] == '(' && !SymbolTable::is_reserved(name) && !symbol_table->contains(name))
+                throw std::invalid_argument("Runtime :: Unknown function " + name + " in expression: " + expression);
+        } else {
+            ++i;
+        }
+    }
+
+    /// A call of a defined function with the arguments in order: name(#0, #1, ...)
+    std::string compact;
+    for (char c : expression)
+        if (c != ' ' && c != '\t')
+            compact.push_back(c);
+
+    std::size_t open = compact.find('(');
+    if (open == std::string::npos || compact.back() != ')')
+        return function;
+
+    std::string name = compact.substr(0, open);
+    if (SymbolTable::is_reserved(name) || !symbol_table->contains(name))
+        return function;
+
+    std::string expected;
+    for (std::size_t k = 0; k < function.arity; ++k)
+        expected += (k ? ",#" : "#") + std::to_string(k);
+
+    if (compact.substr(open + 1, compact.size() - open - 2) == expected &&
+        symbol_table->at(name).first == (int) function.arity)
+    {
+        function.function = name;
+    }
+
+    return function;
+}
+
+Runtime::Value Runtime::call(const Function& function, std::span<const Argument> arguments) const
+{
+    if (arguments.size() != function.arity)
+        throw std::invalid_argument("Runtime :: Expected " + std::to_string(function.arity) +
+                                    " arguments, given " + std::to_string(arguments.size()));
+
+    if (function.function.empty())
+        return run(function.body, arguments);
+
+    const auto&[num_args, body] = symbol_table->at(function.function);
+    if (num_args != (int) arguments.size())
+        throw std::invalid_argument("Runtime :: " + function.function + " was redefined with " +
+                                    std::to_string(num_args) + " arguments.");
+
+    return run(body, arguments);
+}
+
+Runtime::Value Runtime::evaluate(const std::string& expression) const
+{
+    return call(compile(expression), std::span<const Argument>());
+}
+
+void Runtime::set_output(std::ostream& output)
+{
+    this->output = &output;
+}
+
+void Runtime::set_budget(const EvaluationBudget& budget)
+{
+    this->budget = budget;
+}
+
+Runtime::Value Runtime::run(const std::string& body, std::span<const Argument> arguments) const
+{
+    std::vector<std::unique_ptr<Literal>> args;
+    args.reserve(arguments.size());
+
+    AllocationTracker::Site site("runtime");
+    for (const Argument& argument : arguments) {
+        if (argument.list)
+            args.push_back(std::make_unique<List>(std::span<const double>(argument.data, argument.size)));
+        else
+            args.push_back(std::make_unique<Double>(argument.number));
+    }
+
+    std::istringstream input;
+    EvaluationContext context(input, *output);
+    context.set_budget(budget);
+    context.begin_evaluation();
+    Metrics::EvaluationTimer timer;
+
+    StackFrame frame(body, std::move(args), *symbol_table, context);
+    Task<std::unique_ptr<Literal>> task = frame.evaluate();
+    task.resume();
+
+    Value result(std::shared_ptr<const Literal>(task.get()));
+    timer.succeed();
+    return result;
+}
+
+std::size_t Runtime::count_parameters(const std::string& body)
+{
+    std::size_t count = 0;
+    std::size_t len = body.length();
+
+    for (std::size_t i = 0; i < len; ++i) {
+        if (body[i] != '#')
+            continue;
+
+        std::size_t j = i + 1;
+        std::size_t index = 0;
+        while (j < len && '0' <= body[j] && body[j] <= '9')
+            index = index * 10 + (body[j++] - '0');
+
+        if (j == i + 1)
+            throw std::invalid_argument("Runtime :: Invalid parameter in: " + body);
+
+        count = std::max(count, index + 1);
+        i = j - 1;
+    }
+
+    return count;
+}
+
+void Runtime::check_brackets(const std::string& body)
+{
+    std::stack<char> brackets;
+
+    for (char c : body) {
+        if (c == '(' || c == '[') {
+            brackets.push(c);
+        } else if (c == ')' || c == ']') {
+            if (brackets.empty() || brackets.top() != (c == ')' ? '(' : '['))
+                throw std::invalid_argument("Runtime :: Invalid brackets in: " + body);
+            brackets.pop();
+        }
+    }
+
+    if (!brackets.empty())
+        throw std::invalid_argument("Runtime :: Invalid brackets in: " + body);
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "EvaluationContext.h"
+
+class Literal;
+class SymbolTable;
+
+/**
+ * @brief - Entry point for embedding the interpreter in C++ programs.
+ *
+ *          Functions are defined from source once, expressions are checked
+ *          once into a reusable handle and then called with native numbers and
+ *          lists, without formatting or parsing text for the arguments and
+ *          the results. The interpreter evaluates the text of an expression
+ *          as it reads it, so every call still reads the body of the
+ *          expression or of the function it calls.
+ *
+ *          define() and load() must not run concurrently with anything else,
+ *          calls and evaluations may run concurrently with each other.
+ */
+class Runtime {
+public:
+    /**
+     * @brief - A number or a list of numbers passed to a function.
+     *          Refers to the caller's data, which must outlive the call.
+     */
+    class Argument {
+        double        number = 0;
+        const double* data = nullptr;
+        std::size_t   size = 0;
+        bool          list = false;
+
+        friend class Runtime;
+
+    public:
+        Argument(double number);
+        Argument(std::span<const double> list);
+        Argument(const std::vector<double>& list);
+    };
+
+    /**
+     * @brief - The result of a call or an evaluation.
+     */
+    class Value {
+        std::shared_ptr<const Literal> literal;
+
+        friend class Runtime;
+
+        explicit Value(std::shared_ptr<const Literal> literal);
+
+    public:
+        bool is_number() const;
+        bool is_list() const;
+
+        /**
+         * @throws std::invalid_argument - If the value is a list.
+         */
+        double as_number() const;
+
+        /**
+         * @returns - The number of elements of a list, -1 if it is infinite.
+         *
+         * @throws std::invalid_argument - If the value is a number.
+         */
+        int size() const;
+
+        /**
+         * @returns - The element at @p index of a list.
+         *
+         * @throws std::out_of_range - If there is no such element.
+         */
+        Value operator[](std::size_t index) const;
+
+        /**
+         * @returns - The elements of a list of numbers.
+         *
+         * @throws std::invalid_argument - If the value is not a list of numbers.
+         */
+        std::vector<double> as_numbers() const;
+
+        /**
+         * @returns - The value as the interpreter prints it.
+         */
+        std::string to_string() const;
+    };
+
+    /**
+     * @brief - Handle of a checked expression, its text and number of arguments.
+     *          Stays valid after the functions it calls are redefined.
+     */
+    class Function {
+        std::string   body;
+        std::string   function;
+        std::size_t   arity = 0;
+
+        friend class Runtime;
+
+    public:
+        /**
+         * @returns - The number of arguments the expression takes (#0, #1, ...).
+         */
+        std::size_t get_arity() const;
+    };
+
+private:
+    std::unique_ptr<SymbolTable> symbol_table;
+    std::ostream*                output = &std::cout;
+    EvaluationBudget             budget{};
+
+private:
+    static std::size_t count_parameters(const std::string& body);
+    static void check_brackets(const std::string& body);
+
+    Value run(const std::string& body, std::span<const Argument> arguments) const;
+
+public:
+    Runtime();
+    ~Runtime();
+
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+    Runtime(Runtime&&) noexcept;
+    Runtime& operator=(Runtime&&) noexcept;
+
+    /**
+     * @brief - Defines the function @p name with the body @p body,
+     *          in which the arguments are referred to as #0, #1, ...
+     *
+     * @returns - Whether a function with that name was already defined.
+     *
+     * @throws std::invalid_argument - If the name or the body is invalid.
+     */
+    bool define(const std::string& name, const std::string& body);
+
+    /**
+     * @brief - Loads the definitions from a file, like the
+     *          files given on the interpreter's command line.
+     *
+     * @throws std::invalid_argument - On the first invalid line.
+     */
+    void load(const std::string& path);
+
+    /**
+     * @brief - Checks @p expression, in which the arguments of the
+     *          calls are referred to as #0, #1, ..., once instead of on
+     *          every call. It is not parsed ahead of the calls.
+     *          A call of a defined function with its arguments
+     *          in order, like "f(#0, #1)", calls the function directly.
+     *
+     * @throws std::invalid_argument - If the expression is invalid or
+     *                                 calls an unknown function.
+     */
+    Function compile(const std::string& expression) const;
+
+    /**
+     * @brief - Calls the checked expression @p function.
+     *
+     * @throws std::invalid_argument - If the number of arguments does not
+     *                                 match or the evaluation fails.
+     * @throws budget_exceeded_exception - If the budget is exceeded.
+     */
+    Value call(const Function& function, std::span<const Argument> arguments) const;
+
+    template<typename... Args>
+    Value call(const Function& function, const Args&... arguments) const
+    {
+        const std::array<Argument, sizeof...(Args)> list{Argument(arguments)...};
+        return call(function, std::span<const Argument>(list));
+    }
+
+    /**
+     * @brief - Evaluates an expression without arguments.
+     */
+    Value evaluate(const std::string& expression) const;
+
+    /**
+     * @brief - Sets the stream write() prints to, std::cout by default.
+     */
+    void set_output(std::ostream& output);
+
+    /**
+     * @brief - Sets the limits of every call and evaluation.
+     */
+    void set_budget(const EvaluationBudget& budget);
+};
@@ -0,0 +1,281 @@
+#include "fli.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include "Runtime.h"
+#include "budget_exceeded_exception.h"
+
+struct fli_runtime {
+    Runtime runtime;
+};
+
+struct fli_function {
+    Runtime::Function function;
+};
+
+struct fli_value {
+    Runtime::Value value;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+fli_status fail(fli_status status, const char* message)
+{
+    try {
+        last_error = message;
+    } catch (...) {
+        last_error.clear();
+    }
+
+    return status;
+}
+
+/**
+ * @brief - Runs @p action, translating the exceptions it throws into status codes.
+ */
+template<typename Action>
+fli_status guard(Action action) noexcept
+{
+    try {
+        action();
+        last_error.clear();
+        return FLI_OK;
+    } catch (std::invalid_argument& e) {
+        return fail(FLI_ERROR_INVALID_ARGUMENT, e.what());
+    } catch (std::out_of_range& e) {
+        return fail(FLI_ERROR_OUT_OF_RANGE, e.what());
+    } catch (budget_exceeded_exception& e) {
+        return fail(FLI_ERROR_BUDGET_EXCEEDED, e.what());
+    } catch (std::bad_alloc& e) {
+        return fail(FLI_ERROR_OUT_OF_MEMORY, e.what());
+    } catch (std::exception& e) {
+        return fail(FLI_ERROR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(FLI_ERROR_INTERNAL, "Unknown error.");
+    }
+}
+
+fli_status null_argument()
+{
+    return fail(FLI_ERROR_INVALID_ARGUMENT, "fli :: Null argument.");
+}
+
+std::vector<Runtime::Argument> to_arguments(const fli_argument* arguments, std::size_t num_arguments)
+{
+    std::vector<Runtime::Argument> result;
+    result.reserve(num_arguments);
+
+    for (std::size_t i = 0; i < num_arguments; ++i) {
+        if (arguments[i].is_list)
+            result.emplace_back(std::span<const double>(arguments[i].data, arguments[i].size));
+        else
+            result.emplace_back(arguments[i].number);
+    }
+
+    return result;
+}
+
+}
+
+fli_argument fli_number(double number)
+{
+    return fli_argument{number, nullptr, 0, 0};
+}
+
+fli_argument fli_list(const double* data, size_t size)
+{
+    return fli_argument{0, data, size, 1};
+}
+
+const char* fli_last_error(void)
+{
+    return last_error.c_str();
+}
+
+const char* fli_status_string(fli_status status)
+{
+    switch (status) {
+        case FLI_OK:                     return "ok";
+        case FLI_ERROR_INVALID_ARGUMENT: return "invalid argument";
+        case FLI_ERROR_OUT_OF_RANGE:     return "out of range";
+        case FLI_ERROR_BUDGET_EXCEEDED:  return "budget exceeded";
+        case FLI_ERROR_OUT_OF_MEMORY:    return "out of memory";
+        case FLI_ERROR_INTERNAL:         return "internal error";
+    }
+
+    return "unknown status";
+}
+
+///------------------RUNTIME--------------------------
+
+fli_status fli_runtime_create(fli_runtime** runtime)
+{
+    if (!runtime)
+        return null_argument();
+
+    return guard([&] { *runtime = new fli_runtime{}; });
+}
+
+void fli_runtime_free(fli_runtime* runtime)
+{
+    delete runtime;
+}
+
+fli_status fli_define(fli_runtime* runtime, const char* name, const char* body)
+{
+    if (!runtime || !name || !body)
+        return null_argument();
+
+    return guard([&] { runtime->runtime.define(name, body); });
+}
+
+fli_status fli_load(fli_runtime* runtime, const char* path)
+{
+    if (!runtime || !path)
+        return null_argument();
+
+    return guard([&] { runtime->runtime.load(path); });
+}
+
+fli_status fli_set_budget(fli_runtime* runtime, uint64_t max_steps, size_t max_bytes,
+                          uint64_t timeout_ms, size_t max_depth)
+{
+    if (!runtime)
+        return null_argument();
+
+    return guard([&] {
+        runtime->runtime.set_budget(EvaluationBudget{max_steps, max_bytes,
+                                                     std::chrono::milliseconds(timeout_ms), max_depth});
+    });
+}
+
+///------------------FUNCTION--------------------------
+
+fli_status fli_compile(const fli_runtime* runtime, const char* expression, fli_function** function)
+{
+    if (!runtime || !expression || !function)
+        return null_argument();
+
+    return guard([&] { *function = new fli_function{runtime->runtime.compile(expression)}; });
+}
+
+size_t fli_function_arity(const fli_function* function)
+{
+    return function ? function->function.get_arity() : 0;
+}
+
+void fli_function_free(fli_function* function)
+{
+    delete function;
+}
+
+fli_status fli_call(const fli_runtime* runtime, const fli_function* function,
+                    const fli_argument* arguments, size_t num_arguments, fli_value** result)
+{
+    if (!runtime || !function || !result || (!arguments && num_arguments))
+        return null_argument();
+
+    *result = nullptr;
+    return guard([&] {
+        std::vector<Runtime::Argument> args = to_arguments(arguments, num_arguments);
+        *result = new fli_value{runtime->runtime.call(function->function, std::span<const Runtime::Argument>(args))};
+    });
+}
+
+fli_status fli_call_batch(const fli_runtime* runtime, const fli_function* function,
+                          const fli_argument* arguments, size_t num_calls, fli_value** results)
+{
+    if (!runtime || !function || !results || (!arguments && num_calls && function->function.get_arity()))
+        return null_argument();
+
+    std::fill(results, results + num_calls, nullptr);
+
+    std::size_t arity = function->function.get_arity();
+    return guard([&] {
+        std::vector<Runtime::Argument> args = to_arguments(arguments, num_calls * arity);
+        std::span<const Runtime::Argument> all(args);
+
+        for (std::size_t i = 0; i < num_calls; ++i)
+            results[i] = new fli_value{runtime->runtime.call(function->function, all.subspan(i * arity, arity))};
+    });
+}
+
+fli_status fli_evaluate(const fli_runtime* runtime, const char* expression, fli_value** result)
+{
+    if (!runtime || !expression || !result)
+        return null_argument();
+
+    *result = nullptr;
+    return guard([&] { *result = new fli_value{runtime->runtime.evaluate(expression)}; });
+}
+
+///------------------VALUE--------------------------
+
+int fli_value_is_list(const fli_value* value)
+{
+    return value && value->value.is_list();
+}
+
+fli_status fli_value_number(const fli_value* value, double* number)
+{
+    if (!value || !number)
+        return null_argument();
+
+    return guard([&] { *number = value->value.as_number(); });
+}
+
+fli_status fli_value_size(const fli_value* value, int64_t* size)
+{
+    if (!value || !size)
+        return null_argument();
+
+    return guard([&] { *size = value->value.size(); });
+}
+
+fli_status fli_value_at(const fli_value* value, size_t index, fli_value** element)
+{
+    if (!value || !element)
+        return null_argument();
+
+    *element = nullptr;
+    return guard([&] { *element = new fli_value{value->value[index]}; });
+}
+
+fli_status fli_value_numbers(const fli_value* value, double* numbers, size_t capacity, size_t* size)
+{
+    if (!value || !size || (!numbers && capacity))
+        return null_argument();
+
+    return guard([&] {
+        std::vector<double> result = value->value.as_numbers();
+        std::copy_n(result.begin(), std::min(capacity, result.size()), numbers);
+        *size = result.size();
+    });
+}
+
+fli_status fli_value_to_string(const fli_value* value, char* buffer, size_t capacity, size_t* length)
+{
+    if (!value || !length || (!buffer && capacity))
+        return null_argument();
+
+    return guard([&] {
+        std::string result = value->value.to_string();
+        if (capacity) {
+            std::size_t n = std::min(capacity - 1, result.size());
+            std::memcpy(buffer, result.data(), n);
+            buffer[n] = '\0';
+        }
+        *length = result.size();
+    });
+}
+
+void fli_value_free(fli_value* value)
+{
+    delete value;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+/**
+ * @brief - C interface of the interpreter.
+ *
+ *          Every function that can fail returns a fli_status and
+ *          never lets an exception escape; the message of the last
+ *          error on the calling thread is available from fli_last_error().
+ *          Handles returned through out parameters are owned by the
+ *          caller and released with the matching *_free function.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fli_runtime  fli_runtime;
+typedef struct fli_function fli_function;
+typedef struct fli_value    fli_value;
+
+typedef enum fli_status {
+    FLI_OK = 0,
+    FLI_ERROR_INVALID_ARGUMENT,
+    FLI_ERROR_OUT_OF_RANGE,
+    FLI_ERROR_BUDGET_EXCEEDED,
+    FLI_ERROR_OUT_OF_MEMORY,
+    FLI_ERROR_INTERNAL
+} fli_status;
+
+/**
+ * @brief - A number, or a list of numbers when is_list is set.
+ *          The list's data must outlive the call it is passed to.
+ */
+typedef struct fli_argument {
+    double        number;
+    const double* data;
+    size_t        size;
+    int           is_list;
+} fli_argument;
+
+fli_argument fli_number(double number);
+fli_argument fli_list(const double* data, size_t size);
+
+/**
+ * @returns - The message of the last error on this thread, "" if there was none.
+ */
+const char* fli_last_error(void);
+
+const char* fli_status_string(fli_status status);
+
+///------------------RUNTIME--------------------------
+
+fli_status fli_runtime_create(fli_runtime** runtime);
+void       fli_runtime_free(fli_runtime* runtime);
+
+/**
+ * @brief - Defines the function @p name, whose arguments are referred to as #0, #1, ...
+ */
+fli_status fli_define(fli_runtime* runtime, const char* name, const char* body);
+
+/**
+ * @brief - Loads the definitions from the file @p path.
+ */
+fli_status fli_load(fli_runtime* runtime, const char* path);
+
+/**
+ * @brief - Limits every call, 0 meaning unlimited.
+ */
+fli_status fli_set_budget(fli_runtime* runtime, uint64_t max_steps, size_t max_bytes,
+                          uint64_t timeout_ms, size_t max_depth);
+
+///------------------FUNCTION--------------------------
+
+/**
+ * @brief - Checks an expression whose arguments are referred to as #0, #1, ...
+ *          once, for calling it many times. It is still read on every call.
+ */
+fli_status fli_compile(const fli_runtime* runtime, const char* expression, fli_function** function);
+size_t     fli_function_arity(const fli_function* function);
+void       fli_function_free(fli_function* function);
+
+/**
+ * @brief - Calls @p function with @p num_arguments arguments.
+ */
+fli_status fli_call(const fli_runtime* runtime, const fli_function* function,
+                    const fli_argument* arguments, size_t num_arguments, fli_value** result);
+
+/**
+ * @brief - Calls @p function @p num_calls times, the i-th time with the arguments
+ *          arguments[i * arity], ..., arguments[i * arity + arity - 1].
+ *          Stops at the first failing call, the results from it on are set to NULL.
+ */
+fli_status fli_call_batch(const fli_runtime* runtime, const fli_function* function,
+                          const fli_argument* arguments, size_t num_calls, fli_value** results);
+
+/**
+ * @brief - Evaluates an expression without arguments.
+ */
+fli_status fli_evaluate(const fli_runtime* runtime, const char* expression, fli_value** result);
+
+///------------------VALUE--------------------------
+
+int        fli_value_is_list(const fli_value* value);
+fli_status fli_value_number(const fli_value* value, double* number);
+
+/**
+ * @brief - The number of elements of a list, -1 if it is infinite.
+ */
+fli_status fli_value_size(const fli_value* value, int64_t* size);
+fli_status fli_value_at(const fli_value* value, size_t index, fli_value** element);
+
+/**
+ * @brief - Copies the elements of a finite list of numbers to @p numbers.
+ *          @p size is set to the number of elements even if they do not fit.
+ */
+fli_status fli_value_numbers(const fli_value* value, double* numbers, size_t capacity, size_t* size);
+
+/**
+ * @brief - Writes the value, as the interpreter prints it, as a null
+ *          terminated string. @p length is set to its length even if it does not fit.
+ */
+fli_status fli_value_to_string(const fli_value* value, char* buffer, size_t capacity, size_t* length);
+
+void       fli_value_free(fli_value* value);
+
+#ifdef __cplusplus
+}
+#endif
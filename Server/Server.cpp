@@ -0,0 +1,300 @@
+#include "Server.h"
+
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    /// The server stopped by SIGINT and SIGTERM.
+    std::atomic<Server*> signalled_server = nullptr;
+
+    void handle_signal(int)
+    {
+        if (Server* server = signalled_server.load())
+            server->stop();
+    }
+
+    std::system_error system_error(const char* what)
+    {
+        return {errno, std::generic_category(), what};
+    }
+}
+
+Server::Server(const SymbolTable& base_symbol_table,
+               std::string socket_path,
+               std::size_t num_threads,
+               const EvaluationBudget& budget)
+        : base_symbol_table(base_symbol_table),
+          socket_path(std::move(socket_path)),
+          budget(budget)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (this->socket_path.size() >= sizeof(address.sun_path))
+        throw std::invalid_argument("Server :: Socket path is too long: " + this->socket_path);
+
+    std::strcpy(address.sun_path, this->socket_path.c_str());
+
+    struct stat info{};
+    if (stat(address.sun_path, &info) == 0 && S_ISSOCK(info.st_mode))
+        unlink(address.sun_path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0)
+        throw system_error("Server :: socket()");
+
+    if (bind(listen_fd, (sockaddr*) &address, sizeof(address)) < 0) {
+        close(listen_fd);
+        throw system_error("Server :: bind()");
+    }
+
+    if (listen(listen_fd, SOMAXCONN) < 0 ||
+        (epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0 ||
+        (wake_up_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+    {
+        std::system_error error = system_error("Server :: Cannot initialize the event loop");
+        close(listen_fd);
+        if (epoll_fd >= 0)
+            close(epoll_fd);
+        unlink(this->socket_path.c_str());
+        throw error;
+    }
+
+    watch(listen_fd, LISTENER_ID, EPOLLIN, EPOLL_CTL_ADD);
+    watch(wake_up_fd, WAKE_UP_ID, EPOLLIN, EPOLL_CTL_ADD);
+
+    pool = std::make_unique<ThreadPool>(num_threads);
+}
+
+void Server::set_tracer(Tracer* tracer)
+{
+    this->tracer = tracer;
+}
+
+void Server::set_precision(int precision)
+{
+    this->precision = precision;
+}
+
+Server::~Server()
+{
+    /// The workers notify the I/O loop through the eventfd,
+    /// so they are stopped before it is closed.
+    pool.reset();
+    sessions.clear();
+
+    close(wake_up_fd);
+    close(epoll_fd);
+    close(listen_fd);
+    unlink(socket_path.c_str());
+}
+
+void Server::run()
+{
+    Server* expected = nullptr;
+    bool handles_signals = signalled_server.compare_exchange_strong(expected, this);
+
+    struct sigaction action{}, old_int{}, old_term{};
+    if (handles_signals) {
+        action.sa_handler = handle_signal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &old_int);
+        sigaction(SIGTERM, &action, &old_term);
+    }
+
+    epoll_event events[MAX_EVENTS];
+
+    while (!stopping) {
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw system_error("Server :: epoll_wait()");
+        }
+
+        for (int k = 0; k < n; ++k) {
+            std::uint64_t id = events[k].data.u64;
+
+            if (id == LISTENER_ID) {
+                accept_clients();
+                continue;
+            }
+
+            if (id == WAKE_UP_ID) {
+                std::uint64_t counter;
+                while (read(wake_up_fd, &counter, sizeof(counter)) > 0);
+
+                handle_ready_sessions();
+                continue;
+            }
+
+            auto it = sessions.find(id);
+            if (it == sessions.end())
+                continue;
+
+            std::shared_ptr<Session> session = it->second;
+
+            try {
+                if (events[k].events & (EPOLLHUP | EPOLLERR)) {
+                    session->abort();
+                } else {
+                    if (events[k].events & (EPOLLIN | EPOLLRDHUP))
+                        read_requests(*session);
+
+                    if (events[k].events & EPOLLOUT)
+                        write_responses(*session);
+                }
+            } catch (std::exception& e) {
+                session->abort();
+            }
+
+            if (session->is_done())
+                close_session(id);
+        }
+    }
+
+    if (handles_signals) {
+        sigaction(SIGINT, &old_int, nullptr);
+        sigaction(SIGTERM, &old_term, nullptr);
+        signalled_server = nullptr;
+    }
+}
+
+void Server::stop()
+{
+    stopping = true;
+    wake_up();
+}
+
+void Server::accept_clients()
+{
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                std::cerr << "Server :: accept(): " << std::strerror(errno) << '\n';
+            return;
+        }
+
+        std::uint64_t id = next_id++;
+        sessions.emplace(id, std::make_shared<Session>(fd, id, base_symbol_table, budget, tracer, precision));
+        watch(fd, id, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+    }
+}
+
+void Server::read_requests(Session& session)
+{
+    char buffer[4096];
+
+    while (true) {
+        ssize_t n = recv(session.get_fd(), buffer, sizeof(buffer), 0);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            throw system_error("Server :: recv()");
+        }
+
+        if (n == 0) {
+            /// The client closed its input, its pending requests are still
+            /// evaluated and answered but nothing more is read from the socket.
+            session.close_input();
+            write_responses(session);
+            return;
+        }
+
+        if (session.receive(buffer, n))
+            schedule(sessions.at(session.get_id()));
+    }
+}
+
+void Server::write_responses(Session& session)
+{
+    std::uint32_t events = session.is_input_closed() ? 0 : EPOLLIN | EPOLLRDHUP;
+    if (!session.flush())
+        events |= EPOLLOUT;
+
+    watch(session.get_fd(), session.get_id(), events, EPOLL_CTL_MOD);
+}
+
+void Server::handle_ready_sessions()
+{
+    std::vector<std::uint64_t> ids;
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex);
+        ids.swap(ready);
+    }
+
+    for (std::uint64_t id : ids) {
+        auto it = sessions.find(id);
+        if (it == sessions.end())
+            continue;
+
+        Session& session = *it->second;
+        session.collect_responses();
+
+        try {
+            write_responses(session);
+        } catch (std::exception&) {
+            session.abort();
+        }
+
+        if (session.is_done())
+            close_session(id);
+    }
+}
+
+void Server::close_session(std::uint64_t id)
+{
+    auto it = sessions.find(id);
+    if (it == sessions.end())
+        return;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, it->second->get_fd(), nullptr);
+    sessions.erase(it);
+}
+
+void Server::watch(int fd, std::uint64_t id, std::uint32_t events, int operation)
+{
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+
+    if (epoll_ctl(epoll_fd, operation, fd, &event) < 0 && operation != EPOLL_CTL_MOD)
+        throw system_error("Server :: epoll_ctl()");
+}
+
+void Server::schedule(const std::shared_ptr<Session>& session)
+{
+    pool->submit([this, session] {
+        session->process([this, id = session->get_id()] {
+            {
+                std::lock_guard<std::mutex> lock(ready_mutex);
+                ready.push_back(id);
+            }
+            wake_up();
+        });
+    });
+}
+
+void Server::wake_up()
+{
+    std::uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wake_up_fd, &one, sizeof(one));
+}
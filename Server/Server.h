@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SymbolTable.h"
+#include "ThreadPool.h"
+#include "Session.h"
+
+/**
+ * @brief - Evaluation server listening on a Unix domain socket.
+ *
+ *          The definitions are loaded once in the base symbol table,
+ *          which is shared by all sessions. A single I/O loop (epoll)
+ *          accepts the clients and reads their requests, the requests
+ *          are evaluated by a pool of workers.
+ *
+ *          Protocol: every line sent by a client is a request (a function
+ *          definition or an expression). The response is the output of
+ *          the request followed by a line containing a single '.'.
+ *          Errors are reported on lines beginning with "! ".
+ *          A response ending with a line containing a single '?' means
+ *          the evaluation called read(), the next line sent is the number
+ *          it reads. While waiting, the evaluation does not occupy a worker.
+ */
+class Server {
+    static constexpr std::uint64_t LISTENER_ID = 0;
+    static constexpr std::uint64_t WAKE_UP_ID = 1;
+    static constexpr int MAX_EVENTS = 64;
+
+    const SymbolTable& base_symbol_table;
+    std::string socket_path;
+    EvaluationBudget budget;
+    Tracer* tracer = nullptr;
+    int precision = OutputBuffer::DEFAULT_PRECISION;
+
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    int wake_up_fd = -1;
+
+    std::uint64_t next_id = 2;
+    std::unordered_map<std::uint64_t, std::shared_ptr<Session>> sessions{};
+
+    /// Sessions for which a worker produced a response or finished.
+    std::mutex ready_mutex;
+    std::vector<std::uint64_t> ready{};
+
+    std::atomic<bool> stopping = false;
+
+    std::unique_ptr<ThreadPool> pool;
+
+private:
+    void accept_clients();
+    void read_requests(Session& session);
+    void write_responses(Session& session);
+    void handle_ready_sessions();
+    void close_session(std::uint64_t id);
+    void watch(int fd, std::uint64_t id, std::uint32_t events, int operation);
+    void schedule(const std::shared_ptr<Session>& session);
+    void wake_up();
+
+public:
+    /**
+     * @param base_symbol_table - The definitions shared by all sessions.
+     *                            Must not be modified while the server runs.
+     * @param socket_path - The path of the socket, a stale socket left there is replaced.
+     * @param num_threads - The number of workers evaluating requests.
+     * @param budget - The limits of the evaluation of every request.
+     *
+     * @throws std::system_error - If the socket cannot be created.
+     */
+    Server(const SymbolTable& base_symbol_table,
+           std::string socket_path,
+           std::size_t num_threads,
+           const EvaluationBudget& budget = {});
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    ~Server();
+
+    /**
+     * @brief - Records the evaluations of the sessions started from now on to @p tracer.
+     */
+    void set_tracer(Tracer* tracer);
+
+    /**
+     * @brief - Prints the numbers of the sessions started from now on
+     *          with @p precision significant digits, see OutputBuffer::set_precision().
+     */
+    void set_precision(int precision);
+
+    /**
+     * @brief - Serves clients until stop() is called or
+     *          the process receives SIGINT or SIGTERM.
+     */
+    void run();
+
+    /**
+     * @brief - Makes run() return. Can be called from any thread.
+     */
+    void stop();
+};
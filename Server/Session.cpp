@@ -0,0 +1,208 @@
+#include "Session.h"
+
+#include <cstdlib>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include "exit_exception.h"
+
+Session::Session(int fd, std::uint64_t id, const SymbolTable& base_symbol_table,
+                 const EvaluationBudget& budget, Tracer* tracer, int precision)
+        : fd(fd),
+          id(id),
+          symbol_table(&base_symbol_table)
+{
+    context.set_budget(budget);
+    context.set_suspend_on_read(true);
+    context.set_tracer(tracer);
+    context.get_output_buffer().set_precision(precision);
+}
+
+Session::~Session()
+{
+    close(fd);
+}
+
+int Session::get_fd() const
+{
+    return fd;
+}
+
+std::uint64_t Session::get_id() const
+{
+    return id;
+}
+
+bool Session::receive(const char* data, std::size_t size)
+{
+    read_buffer.append(data, size);
+
+    std::size_t begin = 0;
+    std::size_t end;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    while ((end = read_buffer.find('\n', begin)) != std::string::npos) {
+        std::size_t length = end - begin;
+        if (length > 0 && read_buffer[end - 1] == '\r')
+            --length;
+
+        requests.push_back(read_buffer.substr(begin, length));
+        begin = end + 1;
+    }
+    read_buffer.erase(0, begin);
+
+    if (read_buffer.size() > MAX_REQUEST_LENGTH)
+        throw std::length_error("Session :: Request exceeds the maximum length.");
+
+    if (busy || requests.empty() || exited)
+        return false;
+
+    busy = true;
+    return true;
+}
+
+void Session::process(const std::function<void()>& responded)
+{
+    while (true) {
+        std::string request;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (requests.empty() || exited) {
+                requests.clear();
+                busy = false;
+                break;
+            }
+
+            request = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        std::string response = evaluate(request);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            responses += response;
+        }
+
+        responded();
+    }
+
+    responded();
+}
+
+std::string Session::evaluate(const std::string& request)
+{
+    try {
+        if (context.is_waiting_for_input()) {
+            resume_with_input(request);
+        } else {
+            request_stream.clear();
+            request_stream.str(request);
+
+            evaluation = parser.handle(request_stream);
+            evaluation.resume();
+        }
+
+        if (context.is_waiting_for_input())
+            context.get_output() << INPUT_PROMPT;
+        else
+            Task<void>(std::move(evaluation)).get();
+    } catch (exit_exception& e) {
+        context.get_output() << e.what() << '\n';
+        std::lock_guard<std::mutex> lock(mutex);
+        exited = true;
+    } catch (std::exception& e) {
+        write_error(e.what());
+    }
+
+    context.get_output() << END_OF_RESPONSE;
+
+    std::string response = output.str();
+    output.str("");
+
+    return response;
+}
+
+void Session::resume_with_input(const std::string& request)
+{
+    char* end;
+    double value = std::strtod(request.c_str(), &end);
+
+    while (*end == ' ' || *end == '\t')
+        ++end;
+
+    if (end == request.c_str() || *end != '\0') {
+        write_error("Session :: read() expects a number, given: " + request);
+        return;
+    }
+
+    context.provide_input(value);
+}
+
+void Session::write_error(const std::string& message)
+{
+    std::ostream& output = context.get_output();
+    std::size_t begin = 0;
+    std::size_t end;
+
+    while ((end = message.find('\n', begin)) != std::string::npos) {
+        output << ERROR_PREFIX << message.substr(begin, end - begin) << '\n';
+        begin = end + 1;
+    }
+    output << ERROR_PREFIX << message.substr(begin) << '\n';
+}
+
+void Session::collect_responses()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    write_buffer += responses;
+    responses.clear();
+}
+
+bool Session::flush()
+{
+    std::size_t written = 0;
+
+    while (written < write_buffer.size()) {
+        ssize_t n = send(fd, write_buffer.data() + written, write_buffer.size() - written, MSG_NOSIGNAL);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            throw std::system_error(errno, std::generic_category(), "Session :: send()");
+        }
+
+        written += n;
+    }
+
+    write_buffer.erase(0, written);
+    return write_buffer.empty();
+}
+
+void Session::close_input()
+{
+    peer_closed = true;
+}
+
+void Session::abort()
+{
+    peer_closed = true;
+    aborted = true;
+    write_buffer.clear();
+
+    /// Nobody is waiting for the responses anymore.
+    context.cancel();
+}
+
+bool Session::is_done()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !busy && (aborted || (peer_closed || exited) && write_buffer.empty() && responses.empty());
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "SymbolTable.h"
+#include "EvaluationContext.h"
+#include "FunctionParser.h"
+
+/**
+ * @brief - A single client connected to the server.
+ *
+ *          Every session has its own symbol table, an overlay on the
+ *          server's base table, so the definitions of one client are
+ *          not visible to the others.
+ *
+ *          The requests of a session are evaluated one at a time,
+ *          in the order they were received, by a single worker.
+ *          When an evaluation calls read() it is suspended and the worker
+ *          is released, the next request of the client is the number read()
+ *          returns and resumes the evaluation.
+ *          The socket and the buffers used for I/O are only touched
+ *          by the server's I/O loop.
+ */
+class Session {
+public:
+    /// Line terminating every response.
+    static inline const char* END_OF_RESPONSE = ".\n";
+
+    /// Prefix of the lines of a response describing an error.
+    static inline const char* ERROR_PREFIX = "! ";
+
+    /// Last line of a response before END_OF_RESPONSE when
+    /// the evaluation waits for the number of read().
+    static inline const char* INPUT_PROMPT = "?\n";
+
+    /// Sessions sending a longer line are disconnected.
+    static constexpr std::size_t MAX_REQUEST_LENGTH = 1 << 20;
+
+private:
+    const int fd;
+    const std::uint64_t id;
+
+    SymbolTable symbol_table;
+    std::istringstream input{};
+    std::ostringstream output{};
+    EvaluationContext context{input, output};
+    FunctionParser parser{symbol_table, context};
+
+    /// The request being evaluated and its evaluation,
+    /// kept while the evaluation waits for input.
+    std::istringstream request_stream{};
+    Task<void> evaluation{};
+
+    /// Shared between the I/O loop and the worker.
+    std::mutex mutex;
+    std::deque<std::string> requests{};
+    std::string responses{};
+    bool busy = false;
+    bool exited = false;
+
+    /// Used only by the I/O loop.
+    std::string read_buffer{};
+    std::string write_buffer{};
+    bool peer_closed = false;
+    bool aborted = false;
+
+private:
+    std::string evaluate(const std::string& request);
+    void resume_with_input(const std::string& request);
+    void write_error(const std::string& message);
+
+public:
+    Session(int fd, std::uint64_t id, const SymbolTable& base_symbol_table,
+            const EvaluationBudget& budget, Tracer* tracer = nullptr,
+            int precision = OutputBuffer::DEFAULT_PRECISION);
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    /**
+     * @brief - Closes the socket.
+     */
+    ~Session();
+
+    int get_fd() const;
+    std::uint64_t get_id() const;
+
+    /**
+     * @brief - Splits the received data into requests, one per line.
+     *
+     * @returns - Whether the session became busy and
+     *            process() has to be scheduled on a worker.
+     *
+     * @throws std::length_error - If a request exceeds MAX_REQUEST_LENGTH.
+     */
+    bool receive(const char* data, std::size_t size);
+
+    /**
+     * @brief - Evaluates the queued requests until there are none left.
+     *          Called by a worker.
+     *
+     * @param responded - Called after each response and once more
+     *                    when the session is no longer busy.
+     */
+    void process(const std::function<void()>& responded);
+
+    /**
+     * @brief - Moves the responses produced by the worker to the write buffer.
+     */
+    void collect_responses();
+
+    /**
+     * @brief - Writes as much of the write buffer as the socket accepts.
+     *
+     * @returns - Whether the whole buffer was written.
+     *
+     * @throws std::runtime_error - If the socket is broken.
+     */
+    bool flush();
+
+    /**
+     * @brief - Called when the client closed its end of the socket for writing,
+     *          the queued requests are still evaluated and their responses sent.
+     */
+    void close_input();
+
+    bool is_input_closed() const
+    {
+        return peer_closed;
+    }
+
+    /**
+     * @brief - Called when the socket is broken or the client hung up,
+     *          cancels the evaluation in progress and drops the responses.
+     */
+    void abort();
+
+    /**
+     * @returns - Whether the session is not busy and either it was aborted,
+     *            or its responses are sent and the client closed its input
+     *            or typed "exit".
+     */
+    bool is_done();
+};
@@ -1,38 +1,111 @@
 #include <cassert>
 #include "StackFrame.h"
 #include "Expression.h"
+#include "Tracer.h"
 
-StackFrame::StackFrame(const std::string& body, const std::vector<Literal*>& arguments, SymbolTable& symbol_table)
+namespace {
+
+/**
+ * @brief - Calls @p f with the index of each argument in @p text.
+ */
+template<typename F>
+void for_each_argument(std::string_view text, F f)
+{
+    for (std::size_t k = text.find('#'); k != std::string_view::npos; k = text.find('#', k)) {
+        std::size_t idx = 0;
+        for (++k; k < text.size() && '0' <= text[k] && text[k] <= '9'; ++k)
+            idx = idx * 10 + (text[k] - '0');
+
+        f(idx);
+    }
+}
+
+}
+
+StackFrame::StackFrame(const std::string& body,
+                       const std::vector<Literal*>& arguments,
+                       SymbolTable& symbol_table,
+                       EvaluationContext& context,
+                       std::string_view name)
         : body(body),
-          symbol_table(symbol_table)
+          symbol_table(symbol_table),
+          context(context),
+          name(name)
 {
     for (Literal* arg: arguments) {
         if (arg->get_type() == LITERAL_TYPE::LIST)
-            this->arguments.push_back(new List(arg->to_list()));
+            this->arguments.push_back(std::make_unique<List>(arg->to_list()));
+        else if (arg->get_type() == LITERAL_TYPE::INTEGER)
+            this->arguments.push_back(std::make_unique<Integer>(static_cast<const Integer*>(arg)->get_integer()));
         else
-            this->arguments.push_back(new Double(arg->get_double()));
+            this->arguments.push_back(std::make_unique<Double>(arg->get_double()));
     }
+
+    count_uses();
+}
+
+StackFrame::StackFrame(const std::string& body,
+                       std::vector<std::unique_ptr<Literal>> arguments,
+                       SymbolTable& symbol_table,
+                       EvaluationContext& context,
+                       std::string_view name)
+        : body(body),
+          symbol_table(symbol_table),
+          context(context),
+          arguments(std::move(arguments)),
+          name(name)
+{
+    count_uses();
+}
+
+void StackFrame::count_uses()
+{
+    uses.assign(arguments.size(), 0);
+    for_each_argument(body, [this](std::size_t idx) {
+        if (idx < uses.size())
+            ++uses[idx];
+    });
 }
 
-Literal* StackFrame::evaluate()
+void StackFrame::skip(std::string_view text)
 {
-    return Expression(body, symbol_table, this).calculate();
+    for_each_argument(text, [this](std::size_t idx) {
+        if (idx < uses.size())
+            --uses[idx];
+    });
 }
 
-StackFrame::~StackFrame()
+Task<std::unique_ptr<Literal>> StackFrame::evaluate()
 {
-    for (Literal* arg: arguments)
-        delete arg;
+    context.enter_call();
+    Metrics::count_user_call();
+    Tracer::Scope trace(context.get_tracer(), "user", name, arguments);
+
+    try {
+        std::unique_ptr<Literal> result = co_await Expression(body, symbol_table, this, context).calculate_async();
+        context.leave_call();
+        co_return result;
+    } catch (...) {
+        context.leave_call();
+        throw;
+    }
 }
 
-Literal* StackFrame::get_argument(int idx)
+std::unique_ptr<Literal> StackFrame::get_argument(int idx)
 {
     assert(idx < arguments.size());
+    assert(arguments[idx]);
 
-    Literal* lit = arguments[idx];
+    if (--uses[idx] == 0)
+        return std::move(arguments[idx]);
+
+    const Literal* lit = arguments[idx].get();
 
     if (lit->get_type() == LITERAL_TYPE::LIST)
-        return new List(std::move(lit->to_list()));
+        return std::make_unique<List>(lit->to_list());
+
+    if (lit->get_type() == LITERAL_TYPE::INTEGER)
+        return std::make_unique<Integer>(static_cast<const Integer*>(lit)->get_integer());
 
-    return new Double(lit->get_double());
+    return std::make_unique<Double>(lit->get_double());
 }
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "Literal.h"
 #include "SymbolTable.h"
+#include "EvaluationContext.h"
+#include "Task.h"
 
 /**
  * @brief - This class represents a single stack frame containing:
@@ -11,15 +15,40 @@
  *              - The body of the function
  *              - The number of arguments
  *              - The actual arguments.
+ *              - The context of the evaluation it is part of.
+ *              - The name of the function, for tracing.
+ *
+ *          Each occurrence of an argument in the body is evaluated at most once,
+ *          so the last one takes the argument instead of copying it, which lets
+ *          the builtins reuse the lists passed down a recursion, see List.
  */
 class StackFrame {
     SymbolTable& symbol_table;
+    EvaluationContext& context;
     std::string body;
-    std::vector<Literal*> arguments;
+    std::vector<std::unique_ptr<Literal>> arguments;
+    std::string_view name;
+
+    /// The occurrences of each argument in the body that are not evaluated yet.
+    std::vector<std::size_t> uses;
+
+    void count_uses();
 
 public:
-    StackFrame(const std::string& body, const std::vector<Literal*>& arguments, SymbolTable& symbol_table);
-    ~StackFrame();
+    StackFrame(const std::string& body,
+               const std::vector<Literal*>& arguments,
+               SymbolTable& symbol_table,
+               EvaluationContext& context = EvaluationContext::standard(),
+               std::string_view name = {});
+
+    /**
+     * @brief - Takes ownership of @p arguments instead of copying them.
+     */
+    StackFrame(const std::string& body,
+               std::vector<std::unique_ptr<Literal>> arguments,
+               SymbolTable& symbol_table,
+               EvaluationContext& context = EvaluationContext::standard(),
+               std::string_view name = {});
 
     /**
      * @brief Evaluates the body of the the function
@@ -27,12 +56,19 @@ public:
      *
      * @returns The value of the function
      */
-    Literal* evaluate();
+    Task<std::unique_ptr<Literal>> evaluate();
+
+    /**
+     * @returns - A copy of the argument corresponding the @p idx int the @ p arguments vector,
+     *            the argument itself for its last occurrence in the body.
+     */
+    std::unique_ptr<Literal> get_argument(int idx);
 
     /**
-     * @returns - The argument corresponding the @p idx int the @ p arguments vector
+     * @brief - Discounts the occurrences of the arguments in @p text,
+     *          a part of the body which is not evaluated.
      */
-    Literal* get_argument(int idx);
+    void skip(std::string_view text);
 };
 
 
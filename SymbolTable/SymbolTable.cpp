@@ -21,6 +21,16 @@ const std::unordered_set<std::string> SymbolTable::reserved_words{
         "list2",
         "list3",
         "concat",
+        "nth",
+        "take",
+        "drop",
+        "slice",
+        "reverse",
+        "sort",
+        "sortBy",
+        "unique",
+        "indexOf",
+        "binsearch",
         "if",
         "read",
         "write",
@@ -35,6 +45,10 @@ const std::unordered_set<std::string> SymbolTable::reserved_words{
         "E",
 };
 
+SymbolTable::SymbolTable(const SymbolTable* base)
+    : base(base)
+{}
+
 void SymbolTable::add_definition(const std::string& name, const std::pair<int, std::string>& definition)
 {
     if (is_reserved(name))
@@ -48,7 +62,7 @@ bool SymbolTable::contains(const std::string& name) const
     if (is_reserved(name))
         throw std::invalid_argument(name + " is a reserved identifier.");
 
-    return functions.contains(name);
+    return functions.contains(name) || base && base->contains(name);
 }
 
 const std::pair<int, std::string>& SymbolTable::at(const std::string& name) const
@@ -56,6 +70,10 @@ const std::pair<int, std::string>& SymbolTable::at(const std::string& name) cons
     if (is_reserved(name))
         throw std::invalid_argument(name + " is a reserved identifier.");
 
+    auto it = functions.find(name);
+    if (it == functions.end() && base)
+        return base->at(name);
+
     return functions.at(name);
 }
 
@@ -8,21 +8,35 @@
 /**
  * @brief - Class representing a symbol table containing all
  *          user defined names and their definitions and number of arguments.
+ *
+ *          A symbol table can be an overlay on top of a base table.
+ *          Lookups fall through to the base, while new definitions are
+ *          only added to the overlay, so the base can be shared (read only)
+ *          between several overlays.
  */
 class SymbolTable {
     static const std::unordered_set<std::string> reserved_words;
 
     std::unordered_map<std::string, std::pair<int ,std::string>> functions;
 
-private:
-    static bool is_reserved(const std::string& name);
+    const SymbolTable* base = nullptr;
 
 public:
+    /**
+     * @returns - Whether @p name is a built in function, operator or constant.
+     */
+    static bool is_reserved(const std::string& name);
+
+    SymbolTable() = default;
+
+    /**
+     * @param base - The table on top of which this one is an overlay.
+     *               It must outlive the overlay and must not be modified
+     *               while the overlay is in use.
+     */
+    explicit SymbolTable(const SymbolTable* base);
 
     void add_definition(const std::string& name, const std::pair<int, std::string>& definition);
     bool contains(const std::string& name) const;
     const std::pair<int, std::string>& at(const std::string& name) const;
 };
-
-
-
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief - A fixed number of worker threads executing
+ *          the submitted tasks in the order they were submitted.
+ */
+class ThreadPool {
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+
+    std::mutex mutex;
+    std::condition_variable has_task;
+    bool stopping = false;
+
+private:
+    void work();
+
+public:
+    /**
+     * @param num_threads - The number of workers, at least one is always started.
+     *
+     * @throws std::system_error - If a worker cannot be started, the others are stopped.
+     */
+    explicit ThreadPool(std::size_t num_threads);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief - Finishes the already submitted tasks and joins the workers.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief - Queues @p task to be executed by one of the workers.
+     */
+    void submit(std::function<void()> task);
+};
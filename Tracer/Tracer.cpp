@@ -0,0 +1,162 @@
+#include "Tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+
+#include "OutputBuffer.h"
+
+Tracer::Scope::Scope(Tracer* tracer, const char* category, std::string_view name)
+        : tracer(tracer)
+{
+    if (!tracer)
+        return;
+
+    event.category = category;
+    event.name = name;
+    start = clock::now();
+}
+
+Tracer::Scope::Scope(Tracer* tracer, const char* category, std::string_view name,
+                     const std::vector<std::unique_ptr<Literal>>& arguments)
+        : Scope(tracer, category, name)
+{
+    if (tracer)
+        event.arguments = summarize(arguments);
+}
+
+Tracer::Scope::~Scope()
+{
+    if (!tracer)
+        return;
+
+    clock::time_point end = clock::now();
+    event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - tracer->epoch).count();
+    event.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    event.thread_id = current_thread_id();
+
+    try {
+        tracer->record(std::move(event));
+    } catch (...) {
+        /// Losing an event is better than terminating.
+    }
+}
+
+Tracer::Tracer(std::size_t capacity)
+        : capacity(capacity ? capacity : 1)
+{}
+
+std::uint32_t Tracer::current_thread_id()
+{
+    static std::atomic<std::uint32_t> next_id{1};
+    static thread_local std::uint32_t id = next_id++;
+    return id;
+}
+
+void Tracer::record(Event event)
+{
+    std::lock_guard lock(mutex);
+
+    if (events.size() < capacity) {
+        events.push_back(std::move(event));
+    } else {
+        events[next] = std::move(event);
+        ++dropped;
+    }
+
+    next = (next + 1) % capacity;
+}
+
+std::vector<Tracer::Event> Tracer::get_events() const
+{
+    std::lock_guard lock(mutex);
+
+    if (events.size() < capacity)
+        return events;
+
+    std::vector<Event> result;
+    result.reserve(capacity);
+    result.insert(result.end(), events.begin() + (long) next, events.end());
+    result.insert(result.end(), events.begin(), events.begin() + (long) next);
+    return result;
+}
+
+std::size_t Tracer::get_dropped() const
+{
+    std::lock_guard lock(mutex);
+    return dropped;
+}
+
+void Tracer::clear()
+{
+    std::lock_guard lock(mutex);
+    events.clear();
+    next = 0;
+    dropped = 0;
+}
+
+void Tracer::write_escaped(std::ostream& os, const std::string& text)
+{
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if ((unsigned char) c < 0x20)
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec << std::setfill(' ');
+        else
+            os << c;
+    }
+}
+
+void Tracer::write_json(std::ostream& os) const
+{
+    std::vector<Event> recorded = get_events();
+
+    os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+    for (std::size_t i = 0; i < recorded.size(); ++i) {
+        const Event& event = recorded[i];
+
+        os << (i ? ",\n" : "\n");
+        os << "{\"name\": \"";
+        write_escaped(os, event.name);
+        os << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\""
+           << ", \"ts\": " << event.start_ns / 1000 << '.' << std::setw(3) << std::setfill('0') << event.start_ns % 1000
+           << ", \"dur\": " << event.duration_ns / 1000 << '.' << std::setw(3) << event.duration_ns % 1000
+           << std::setfill(' ')
+           << ", \"pid\": 1, \"tid\": " << event.thread_id;
+
+        if (!event.arguments.empty()) {
+            os << ", \"args\": {\"arguments\": \"";
+            write_escaped(os, event.arguments);
+            os << "\"}";
+        }
+
+        os << '}';
+    }
+
+    os << "\n]}\n";
+}
+
+std::string Tracer::summarize(const std::vector<std::unique_ptr<Literal>>& arguments)
+{
+    std::ostringstream os;
+
+    /// Only the beginning of long lists is formatted, one past the limit to tell they are cut.
+    {
+        OutputBuffer buffer(os, 2 * MAX_SUMMARY_LENGTH);
+        for (std::size_t i = 0; i < arguments.size() && buffer.size() <= MAX_SUMMARY_LENGTH; ++i) {
+            if (i)
+                buffer.write(", ");
+            buffer.write(*arguments[i], MAX_SUMMARY_LENGTH + 1 - std::min(buffer.size(), MAX_SUMMARY_LENGTH));
+        }
+    }
+
+    std::string summary = os.str();
+    if (summary.size() > MAX_SUMMARY_LENGTH) {
+        summary.resize(MAX_SUMMARY_LENGTH - 3);
+        summary += "...";
+    }
+
+    return summary;
+}
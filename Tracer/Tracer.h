@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Literal.h"
+
+/**
+ * @brief - Records the spans of the evaluations, the user function calls
+ *          and the built in function calls in a ring buffer keeping the
+ *          latest events, and writes them in the Chrome trace event
+ *          format, viewable in chrome://tracing or Perfetto.
+ *
+ *          Can be shared by the threads of the server.
+ */
+class Tracer {
+    using clock = std::chrono::steady_clock;
+
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1 << 16;
+
+    /// The longest argument summary kept, longer ones are cut.
+    static constexpr std::size_t MAX_SUMMARY_LENGTH = 64;
+
+    struct Event {
+        const char*   category;
+        std::string   name;
+        std::string   arguments;
+        std::int64_t  start_ns;     /// Since the tracer was created.
+        std::int64_t  duration_ns;
+        std::uint32_t thread_id;
+    };
+
+    /**
+     * @brief - Records a span lasting as long as it lives.
+     */
+    class Scope {
+        Tracer* tracer;
+        Event   event;
+        clock::time_point start;
+
+    public:
+        /**
+         * @param tracer - The tracer, nullptr when not tracing.
+         * @param category - "eval", "user" or "builtin".
+         */
+        Scope(Tracer* tracer, const char* category, std::string_view name);
+        Scope(Tracer* tracer, const char* category, std::string_view name, const std::vector<std::unique_ptr<Literal>>& arguments);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    const clock::time_point epoch = clock::now();
+
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::size_t capacity;
+    std::size_t next = 0;       /// Where the next event goes.
+    std::size_t dropped = 0;    /// Number of overwritten events.
+
+private:
+    static std::uint32_t current_thread_id();
+    static void write_escaped(std::ostream& os, const std::string& text);
+
+public:
+    explicit Tracer(std::size_t capacity = DEFAULT_CAPACITY);
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief - Adds @p event, overwriting the oldest one when the buffer is full.
+     */
+    void record(Event event);
+
+    /**
+     * @returns - The recorded events from the oldest to the latest.
+     */
+    std::vector<Event> get_events() const;
+
+    /**
+     * @returns - The number of events overwritten because the buffer was full.
+     */
+    std::size_t get_dropped() const;
+
+    void clear();
+
+    /**
+     * @brief - Writes the recorded events as a Chrome trace event JSON document.
+     */
+    void write_json(std::ostream& os) const;
+
+    /**
+     * @returns - A short description of @p arguments, like "1, [1 2 3]".
+     */
+    static std::string summarize(const std::vector<std::unique_ptr<Literal>>& arguments);
+};
@@ -1,6 +1,16 @@
+#include <condition_variable>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "Interpreter.h"
+#include "HashCons.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include "Tracer.h"
 
 /**
  *                  DOCUMENTATION
@@ -27,6 +37,17 @@
  *      - list2(#0, #1)
  *      - list3(#0, #1, #2)
  *      - concat(#0, #1)
+ *      - nth(#0, #1)
+ *      - take(#0, #1)
+ *      - drop(#0, #1)
+ *      - slice(#0, #1, #2)
+ *      - reverse(#0)
+ *      - sort(#0)
+ *      - sortBy(#0, name) - sorts by the user defined function "name" of two
+ *                           arguments, true when the first comes before the second.
+ *      - unique(#0)
+ *      - indexOf(#0, #1)
+ *      - binsearch(#0, #1)
  *      - if(#0, #1, #2)
  *      - read()
  *      - write(#0)
@@ -50,9 +71,86 @@
  * The constants PI and E are also available (MUST BE spelled with upper case letters).
  *
  * There are only two types of literals:
- *      - Number (double).
+ *      - Number, an exact integer of any size or a double.
+ *        Integer literals are integers, which +, -, *, % and int() keep,
+ *        as / does when it leaves no remainder, the results of the other
+ *        operations are doubles.
+ *        The numbers of lists are doubles, the integers among them are
+ *        integers again when taken out of the list. Integers past 2^53 are
+ *        kept exact in lists, which then are not operands of element-wise
+ *        operations.
+ *        Numbers are written in decimal, with an optional exponent (1.5e-3),
+ *        or in hexadecimal (0xFF, 0x1.8p3).
  *      - List.
  *
+ * Options:
+ *      --server <socket path>  - Instead of reading from the standard input,
+ *                                serve the clients connecting to the Unix domain
+ *                                socket. The definitions are loaded only once and
+ *                                are shared by all clients, each client's own
+ *                                definitions are visible only to it.
+ *                                Every line sent is a request, the response ends
+ *                                with a line containing a single '.'.
+ *                                When an evaluation calls read(), the response
+ *                                ends with a '?' line and the next line sent is
+ *                                the number read. A waiting evaluation does not
+ *                                occupy any thread.
+ *                                Use the Client executable to connect.
+ *      --threads <number>      - The number of threads evaluating the requests
+ *                                of the clients (default: the number of cores).
+ *
+ * Limits of every evaluation (not limited by default), an evaluation exceeding
+ * one of them is aborted with an error:
+ *      --max-steps <number>    - Number of evaluation steps.
+ *      --max-memory <bytes>    - Number of bytes allocated for literals.
+ *      --timeout <ms>          - Wall-clock time in milliseconds.
+ *      --max-depth <number>    - Depth of nested user function calls,
+ *                                protects against infinite recursion.
+ *
+ * Profiling of the user defined functions:
+ *      --profile               - On exit prints to the standard error, per function,
+ *                                the number of calls, the time spent in it with and
+ *                                without the functions it calls and the literals it
+ *                                allocated.
+ *      --profile-stacks <path> - On exit writes the time spent per call stack to
+ *                                path, in the collapsed format of flame graph tools
+ *                                ("f;g;h <microseconds>" per line). Implies --profile.
+ *
+ * Tracing:
+ *      --trace <path>          - Records the evaluations, the user function calls and
+ *                                the built in function calls, keeping the latest ones,
+ *                                and on exit writes them to path in the Chrome trace
+ *                                event format (open it in chrome://tracing or Perfetto).
+ *                                The command ":trace" prints the events recorded so far.
+ *
+ * Metrics (evaluations, calls, literals, latency), printed by the command ":stats":
+ *      --metrics <path>        - Writes the metrics in the Prometheus text format to path
+ *                                periodically and on exit.
+ *      --metrics-interval <s>  - Seconds between the writes (default: 10).
+ *
+ * Output:
+ *      --precision <digits>    - Significant digits of the numbers printed (default: 6,
+ *                                at most 17), 0 for the fewest digits which read back
+ *                                as the same number.
+ *                                The results are written in large blocks when the input
+ *                                is not a terminal, and before read() waits for a number.
+ *      --output <format>       - "text" (default) prints "> value" per result, "ndjson"
+ *                                prints a JSON object per line for every request read
+ *                                from the standard input:
+ *                                    {"id":3,"value":[1,[2,3]],"elapsed_us":12}
+ *                                    {"id":4,"error":"...","elapsed_us":5}
+ *                                    {"id":1,"defined":"f","redefined":false}
+ *                                    {"id":3,"write":5} per write() of the evaluation
+ *                                The id is the number of the request's first line, the
+ *                                numbers are exact (infinite and NaN are null) and an
+ *                                infinite list is written as its step and the elements
+ *                                generated so far: {"infinite":true,"step":1,"first":[1,2]}.
+ *
+ * Memory:
+ *      --hash-cons             - Keeps one copy of equal lists and of equal numbers in
+ *                                lists, which makes comparing equal lists constant time
+ *                                and saves memory when values repeat.
+ *
  * Comments are supported. Every line beginning with '//'
  * will be treated as a comment. Comments are only allowed outside function
  * definitions.
@@ -65,6 +163,9 @@
  *      - Lists and Numbers both can be used as Boolean Values:
  *          - 0.0 == False / Every other number == True
  *          - The empty list ([]) == False / List with at least one element == True.
+ *      - The operators, their functions, sqrt(), int() and le() work element-wise
+ *        on lists of numbers of the same length and on a list of numbers and a
+ *        number: [1, 2] + [10, 20] == [11, 22], [1, 2] * 2 == [2, 4].
  *      - Parenthesis follow immediately after each function call,
  *        no whitespaces allowed.
  *      - Each argument should be separated by a comma (',').
@@ -81,9 +182,144 @@
 
 int main(int argc, char** argv)
 {
-    Interpreter interpreter(argv + 1, argc - 1);
+    std::string socket_path;
+    std::size_t num_threads = std::thread::hardware_concurrency();
+    std::vector<char*> paths;
+    EvaluationBudget budget;
+    bool profile = false;
+    std::string profile_stacks_path;
+    std::string trace_path;
+    std::string metrics_path;
+    long metrics_interval = 10;
+    int precision = OutputBuffer::DEFAULT_PRECISION;
+    OUTPUT_FORMAT output_format = OUTPUT_FORMAT::TEXT;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--server" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--max-steps" && i + 1 < argc) {
+            budget.max_steps = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-memory" && i + 1 < argc) {
+            budget.max_bytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            budget.timeout = std::chrono::milliseconds(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--max-depth" && i + 1 < argc) {
+            budget.max_depth = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--profile-stacks" && i + 1 < argc) {
+            profile = true;
+            profile_stacks_path = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if (arg == "--metrics-interval" && i + 1 < argc) {
+            metrics_interval = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--precision" && i + 1 < argc) {
+            precision = (int) std::strtol(argv[++i], nullptr, 10);
+        } else if (arg == "--output" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "ndjson") {
+                output_format = OUTPUT_FORMAT::NDJSON;
+            } else if (format != "text") {
+                std::cerr << "Unknown output format " << format << ", expected text or ndjson\n";
+                return 1;
+            }
+        } else if (arg == "--hash-cons") {
+            HashCons::set_enabled(true);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    Interpreter interpreter;
+    interpreter.set_budget(budget);
+    interpreter.set_output_format(output_format);
+
+    try {
+        interpreter.set_precision(precision);
+    } catch (std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    interpreter.load(paths.data(), (int) paths.size());
+
+    Tracer tracer;
+    if (!trace_path.empty())
+        interpreter.set_tracer(&tracer);
+
+    std::jthread metrics_writer;
+    if (!metrics_path.empty()) {
+        metrics_writer = std::jthread([&](std::stop_token stop) {
+            auto write = [&] {
+                try {
+                    Metrics::write_prometheus_file(metrics_path);
+                } catch (std::exception& e) {
+                    std::cerr << e.what() << '\n';
+                }
+            };
+
+            std::mutex mutex;
+            std::condition_variable_any stopped;
+            std::unique_lock lock(mutex);
+
+            while (!stop.stop_requested()) {
+                write();
+                stopped.wait_for(lock, stop, std::chrono::seconds(metrics_interval), [] { return false; });
+            }
+
+            /// The final counts.
+            write();
+        });
+    }
+
+    if (socket_path.empty()) {
+        Profiler profiler;
+        if (profile)
+            interpreter.set_profiler(&profiler);
+
+        interpreter.run();
+
+        if (profile) {
+            profiler.write_table(std::cerr);
+
+            if (!profile_stacks_path.empty()) {
+                std::ofstream ofs(profile_stacks_path);
+                profiler.write_collapsed_stacks(ofs);
+                if (!ofs) {
+                    std::cerr << "Cannot write " << profile_stacks_path << '\n';
+                    return 1;
+                }
+            }
+        }
+    } else {
+        try {
+            interpreter.serve(socket_path, num_threads);
+        } catch (std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    if (metrics_writer.joinable()) {
+        metrics_writer.request_stop();
+        metrics_writer.join();
+    }
 
-    interpreter.run();
+    if (!trace_path.empty()) {
+        std::ofstream ofs(trace_path);
+        tracer.write_json(ofs);
+        if (!ofs) {
+            std::cerr << "Cannot write " << trace_path << '\n';
+            return 1;
+        }
+    }
 
     return 0;
 }
\ No newline at end of file
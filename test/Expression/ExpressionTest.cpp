@@ -3,6 +3,27 @@
 #include "catch.hpp"
 
 #include "Expression.h"
+#include "budget_exceeded_exception.h"
+#include "evaluation_cancelled_exception.h"
+#include "AsyncEvaluation.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "Metrics.h"
+#include "FunctionParser.h"
+
+#include <regex>
+#include <sstream>
+
+/**
+ * @returns - The result of @p expression as the interpreter prints it.
+ */
+static std::string calculate(const char* expression, SymbolTable& symbolTable)
+{
+    std::unique_ptr<Literal> result(Expression(expression, symbolTable).calculate());
+    std::ostringstream os;
+    os << *result;
+    return os.str();
+}
 
 TEST_CASE("Expression add")
 {
@@ -152,6 +173,67 @@ TEST_CASE("Expression eq")
     delete result8;
 }
 
+TEST_CASE("Expression eq of nested and infinite lists")
+{
+    SymbolTable symbolTable;
+
+    auto eq = [&](const char* expression) {
+        Literal* result = Expression(expression, symbolTable).calculate();
+        bool equal = *result == Double(1);
+        delete result;
+        return equal;
+    };
+
+    REQUIRE(eq("eq([1, [2, 3], []], [1, [2, 3], []])"));
+    REQUIRE_FALSE(eq("eq([1, [2, 3], []], [1, [2, 4], []])"));
+    REQUIRE_FALSE(eq("eq([1, [2, 3]], [1, 2, 3])"));
+    REQUIRE(eq("eq([[1], 2], [1, [2]])"));
+    REQUIRE(eq("eq(2, [[2]])"));
+    REQUIRE(eq("eq([1, 2.000001], [1, 2])"));
+    REQUIRE(eq("eq(list(1, 1), list(1, 1))"));
+    REQUIRE_FALSE(eq("eq(list(1, 1), list(1, 2))"));
+    REQUIRE_FALSE(eq("eq(concat([0], list(1, 1)), list(0, 1))"));
+
+    /// Comparing does not copy the lists.
+    Metrics::Snapshot before = Metrics::snapshot();
+    REQUIRE(eq("eq(list(1, 1, 1000), list(1, 1, 1000))"));
+    REQUIRE(Metrics::snapshot().list_nodes_copied == before.list_nodes_copied);
+}
+
+TEST_CASE("Expression element-wise operations on lists")
+{
+    SymbolTable symbolTable;
+
+    REQUIRE(calculate("[1, 2, 3] + [10, 20, 30]", symbolTable) == "[11 22 33]");
+    REQUIRE(calculate("[1, 2, 3, 4, 5] - 1", symbolTable) == "[0 1 2 3 4]");
+    REQUIRE(calculate("10 - [1, 2, 3, 4, 5]", symbolTable) == "[9 8 7 6 5]");
+    REQUIRE(calculate("2 * list(1, 1, 6) / 4", symbolTable) == "[0.5 1 1.5 2 2.5 3]");
+    REQUIRE(calculate("[2, 3] ^ 2", symbolTable) == "[4 9]");
+    REQUIRE(calculate("[7, 8, 9] % 4", symbolTable) == "[3 0 1]");
+    REQUIRE(calculate("sqrt([1, 4, 9, 16, 25])", symbolTable) == "[1 2 3 4 5]");
+    REQUIRE(calculate("int([1.5, 2.5, 2] - 3)", symbolTable) == "[-2 -1 -1]");
+    REQUIRE(calculate("le([1, 5, 3], [2, 2, 3])", symbolTable) == "[1 0 0]");
+    REQUIRE(calculate("le(list(1, 1, 5), 3)", symbolTable) == "[1 1 0 0 0]");
+    REQUIRE(calculate("-[1, 2]", symbolTable) == "[-1 -2]");
+    REQUIRE(calculate("add([1], mul(2, [3]))", symbolTable) == "[7]");
+    REQUIRE(calculate("[] + 1", symbolTable) == "[]");
+
+    /// Infinite lists stay arithmetic lists.
+    REQUIRE(calculate("list(1, 1) * 2 + 1", symbolTable) == "[3 5 7 9 11 13 15 17 19 21 ...]");
+    REQUIRE(calculate("tail(list(1, 1) * 2)", symbolTable) == "[4 6 8 10 12 14 16 18 20 22 ...]");
+    REQUIRE(calculate("list(1, 1) + list(0, 2)", symbolTable) == "[1 4 7 10 13 16 19 22 25 28 ...]");
+    REQUIRE(calculate("-list(1, 1)", symbolTable) == "[-1 -2 -3 -4 -5 -6 -7 -8 -9 -10 ...]");
+
+    REQUIRE_THROWS_AS(calculate("[1, 2] + [1, 2, 3]", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("[1, [2]] + 1", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("[1.5] % 2", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("[1, 2] % 0", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("[1, 2] % [1, 0]", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("list(1, 1) * list(1, 1)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("sqrt(list(1, 1))", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("concat([1], [2]) + list(1, 1)", symbolTable), std::invalid_argument);
+}
+
 TEST_CASE("Expression le")
 {
     SymbolTable symbolTable;
@@ -173,18 +255,24 @@ TEST_CASE("Expression le")
     Literal* result9 = expr9.calculate();
     REQUIRE_THROWS_AS(expr1.calculate(), std::invalid_argument);
     REQUIRE_THROWS_AS(expr2.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr3.calculate(), std::invalid_argument);
+    Literal* result3 = expr3.calculate();
     REQUIRE_THROWS_AS(expr4.calculate(), std::invalid_argument);
     REQUIRE_THROWS_AS(expr5.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr7.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr8.calculate(), std::invalid_argument);
+    Literal* result7 = expr7.calculate();
+    Literal* result8 = expr8.calculate();
 
     REQUIRE(*result == Double(0));
     REQUIRE(*result6 == Double(0));
     REQUIRE(*result9 == Double(1));
+    REQUIRE(*result3 == List(std::vector<double>{0, 0, 0}));
+    REQUIRE(*result7 == List(std::vector<double>{0}));
+    REQUIRE(*result8 == List(std::vector<double>{0, 0}));
 
     delete result;
     delete result6;
+    delete result3;
+    delete result7;
+    delete result8;
 }
 
 TEST_CASE("Expression length")
@@ -336,6 +424,104 @@ TEST_CASE("Expression concat")
     delete result3;
 }
 
+TEST_CASE("Expression nth, take, drop, slice and reverse")
+{
+    SymbolTable symbolTable;
+
+    REQUIRE(calculate("nth([1, 2, 3], 2)", symbolTable) == "3");
+    REQUIRE(calculate("nth([1, [2, 3]], 1)", symbolTable) == "[2 3]");
+    REQUIRE(calculate("nth(list(1, 1), 1000)", symbolTable) == "1001");
+    REQUIRE(calculate("take(list(1, 1), 3)", symbolTable) == "[1 2 3]");
+    REQUIRE(calculate("take([1, 2], 3)", symbolTable) == "[1 2]");
+    REQUIRE(calculate("drop([1, 2, 3], 1)", symbolTable) == "[2 3]");
+    REQUIRE(calculate("drop(list(1, 1), 5)", symbolTable) == "[6 7 8 9 10 11 12 13 14 15 ...]");
+    REQUIRE(calculate("slice(list(1, 1, 10), 2, 5)", symbolTable) == "[3 4 5]");
+    REQUIRE(calculate("reverse([1, [2], 3])", symbolTable) == "[3 [2] 1]");
+    REQUIRE(calculate("reverse(take(list(1, 1), 3)) + 1", symbolTable) == "[4 3 2]");
+    REQUIRE(calculate("nth(7, 0)", symbolTable) == "7");
+
+    REQUIRE_THROWS_AS(calculate("nth([1, 2], 2)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("nth([1, 2], 0.5)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("take([1, 2], -1)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("slice([1, 2], 2, 1)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("reverse(list(1))", symbolTable), std::invalid_argument);
+
+    /// Indices from 2^64 on are past the end of any list.
+    REQUIRE_THROWS_AS(calculate("nth([1, 2, 3], 1e20)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("nth(list(1, 1), 2 ^ 64)", symbolTable), std::invalid_argument);
+    REQUIRE(calculate("take([1, 2, 3], 1e30)", symbolTable) == "[1 2 3]");
+    REQUIRE(calculate("drop([1, 2, 3], 1e30)", symbolTable) == "[]");
+    REQUIRE(calculate("slice([1, 2, 3], 1, 1e30)", symbolTable) == "[2 3]");
+    REQUIRE_THROWS_AS(calculate("drop(list(1, 1), 1e30)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("slice(list(1, 1), 0, 1e30)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("take(list(1, 1), 1e30)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(symbolTable.add_definition("nth", {1, "#0"}), std::invalid_argument);
+}
+
+TEST_CASE("Expression sort, sortBy, unique, indexOf and binsearch")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("greater", {2, "le(#1, #0)"});
+    symbolTable.add_definition("shorter", {2, "le(length(#0), length(#1))"});
+    symbolTable.add_definition("id", {1, "#0"});
+
+    REQUIRE(calculate("sort([3, 1, 2])", symbolTable) == "[1 2 3]");
+    REQUIRE(calculate("unique(sort([3, 1, 3, 2, 1]))", symbolTable) == "[1 2 3]");
+    REQUIRE(calculate("unique([1, 1, 2, 2, 3, 1])", symbolTable) == "[1 2 3]");
+    REQUIRE(calculate("unique([2, [1], 2, [1], 0])", symbolTable) == "[2 [1] 0]");
+    REQUIRE(calculate("sortBy([3, 1, 2], greater)", symbolTable) == "[3 2 1]");
+    REQUIRE(calculate("sortBy([[1, 2, 3], [4], [5, 6], [7]], shorter)", symbolTable) == "[[4] [7] [5 6] [1 2 3]]");
+    REQUIRE(calculate("sortBy([], greater)", symbolTable) == "[]");
+    REQUIRE(calculate("indexOf([5, [6], 7], [6])", symbolTable) == "1");
+    REQUIRE(calculate("indexOf([5, 6, 7], 8)", symbolTable) == "-1");
+    REQUIRE(calculate("binsearch(list(0, 2, 100), 64)", symbolTable) == "32");
+    REQUIRE(calculate("binsearch(list(0, 2, 100), 65)", symbolTable) == "-1");
+
+    REQUIRE_THROWS_AS(calculate("sort([1, [2]])", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("sort(list(1))", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("sortBy([2, 1], id)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("sortBy([2, 1], unknown)", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("sortBy([2, 1], le)", symbolTable), std::invalid_argument);
+}
+
+TEST_CASE("Expression reusing lists")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("len", {1, "if(length(#0), len(tail(#0)) + 1, 0)"});
+    symbolTable.add_definition("rotate", {1, "concat(tail(#0), take(#0, 1))"});
+    symbolTable.add_definition("centered", {1, "#0 - sort(#0)"});
+
+    /// The last use of an argument passes it down instead of copying it.
+    Metrics::Snapshot before = Metrics::snapshot();
+    REQUIRE(calculate("len(sort(reverse(list(1, 1, 1000) * 2)))", symbolTable) == "1000");
+
+    Metrics::Snapshot after = Metrics::snapshot();
+    REQUIRE(after.lists_reused - before.lists_reused >= 1000);
+    REQUIRE(after.list_nodes_copied == before.list_nodes_copied);
+
+    /// The uses before the last one see the argument unchanged.
+    REQUIRE(calculate("rotate([1, 2, 3])", symbolTable) == "[2 3 1]");
+    REQUIRE(calculate("centered([3, 1, 2])", symbolTable) == "[2 -1 -1]");
+    REQUIRE(calculate("eq(tail(list(1, 2)) + list(0, 1), list(3, 3))", symbolTable) == "1");
+}
+
+TEST_CASE("Expression building a list by concat")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("build", {1, "if(#0, concat(build(#0 - 1), list(#0, 0, 1)), [])"});
+    symbolTable.add_definition("sum", {1, "if(length(#0), head(#0) + sum(tail(#0)), 0)"});
+
+    Expression expr("sum(build(3000))", symbolTable);
+    Literal* result = expr.calculate();
+    REQUIRE(*result == Double(3000 * 3001 / 2));
+    delete result;
+
+    Expression expr2("nth(build(3000), 1234) + length(build(3000))", symbolTable);
+    result = expr2.calculate();
+    REQUIRE(*result == Double(1235 + 3000));
+    delete result;
+}
+
 TEST_CASE("Expression int")
 {
     SymbolTable symbolTable;
@@ -434,11 +620,13 @@ TEST_CASE("Expression +")
     Literal* result = expr.calculate();
     REQUIRE_THROWS_AS(expr2.calculate(), std::invalid_argument);
     REQUIRE_THROWS_AS(expr3.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr4.calculate(), std::invalid_argument);
+    Literal* result4 = expr4.calculate();
 
     REQUIRE(*result == Double(3));
+    REQUIRE(*result4 == List(std::vector<double>{3}));
 
     delete result;
+    delete result4;
 }
 
 TEST_CASE("Expression -")
@@ -452,11 +640,13 @@ TEST_CASE("Expression -")
     Literal* result = expr.calculate();
     REQUIRE_THROWS_AS(expr2.calculate(), std::invalid_argument);
     REQUIRE_THROWS_AS(expr3.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr4.calculate(), std::invalid_argument);
+    Literal* result4 = expr4.calculate();
 
     REQUIRE(*result == Double(-1));
+    REQUIRE(*result4 == List(std::vector<double>{-1}));
 
     delete result;
+    delete result4;
 }
 
 TEST_CASE("Expression *")
@@ -470,11 +660,13 @@ TEST_CASE("Expression *")
     Literal* result = expr.calculate();
     REQUIRE_THROWS_AS(expr2.calculate(), std::invalid_argument);
     REQUIRE_THROWS_AS(expr3.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr4.calculate(), std::invalid_argument);
+    Literal* result4 = expr4.calculate();
 
     REQUIRE(*result == Double(2));
+    REQUIRE(*result4 == List(std::vector<double>{2}));
 
     delete result;
+    delete result4;
 }
 
 TEST_CASE("Expression /")
@@ -488,11 +680,13 @@ TEST_CASE("Expression /")
     Literal* result = expr.calculate();
     REQUIRE_THROWS_AS(expr2.calculate(), std::invalid_argument);
     REQUIRE_THROWS_AS(expr3.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr4.calculate(), std::invalid_argument);
+    Literal* result4 = expr4.calculate();
 
     REQUIRE(*result == Double(0.5));
+    REQUIRE(*result4 == List(std::vector<double>{0.5}));
 
     delete result;
+    delete result4;
 }
 
 TEST_CASE("Expression ^")
@@ -506,11 +700,13 @@ TEST_CASE("Expression ^")
     Literal* result = expr.calculate();
     REQUIRE_THROWS_AS(expr2.calculate(), std::invalid_argument);
     REQUIRE_THROWS_AS(expr3.calculate(), std::invalid_argument);
-    REQUIRE_THROWS_AS(expr4.calculate(), std::invalid_argument);
+    Literal* result4 = expr4.calculate();
 
     REQUIRE(*result == Double(1));
+    REQUIRE(*result4 == List(std::vector<double>{1}));
 
     delete result;
+    delete result4;
 }
 
 TEST_CASE("Expression %")
@@ -537,6 +733,112 @@ TEST_CASE("Expression %")
     delete result1;
 }
 
+TEST_CASE("Expression integers")
+{
+    SymbolTable symbolTable;
+
+    auto type = [&](const char* expression) {
+        return std::unique_ptr<Literal>(Expression(expression, symbolTable).calculate())->get_type();
+    };
+
+    /// Integers are exact past 2^53.
+    REQUIRE(calculate("3037000499 * 3037000499", symbolTable) == "9223372030926249001");
+    REQUIRE(calculate("9007199254740993 - 1", symbolTable) == "9007199254740992");
+    REQUIRE(calculate("le(9007199254740992, 9007199254740993)", symbolTable) == "1");
+    REQUIRE(calculate("-9223372036854775807 - 1", symbolTable) == "-9223372036854775808");
+    REQUIRE(calculate("123456789 * 987654321 % 1000000007", symbolTable) == "259106859");
+    REQUIRE(calculate("int(7.5) + int(-7.5)", symbolTable) == "-1");
+
+    REQUIRE(type("1 + 2 * 3 - 4 % 3") == LITERAL_TYPE::INTEGER);
+    REQUIRE(type("int(sqrt(16))") == LITERAL_TYPE::INTEGER);
+    REQUIRE(type("length([1, 2])") == LITERAL_TYPE::INTEGER);
+    REQUIRE(type("head([1, 2.5])") == LITERAL_TYPE::INTEGER);
+    REQUIRE(type("nth([1, 2.5], 1)") == LITERAL_TYPE::DOUBLE);
+
+    /// Otherwise the results are doubles.
+    REQUIRE(type("7 / 2") == LITERAL_TYPE::DOUBLE);
+    REQUIRE(type("2 ^ 3") == LITERAL_TYPE::DOUBLE);
+    REQUIRE(type("1 + 0.5") == LITERAL_TYPE::DOUBLE);
+
+    REQUIRE_THROWS_AS(calculate("5 % 0", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("mod(5.0, 0)", symbolTable), std::invalid_argument);
+    REQUIRE(calculate("mod(2 ^ 40, 7)", symbolTable) == "2");
+    REQUIRE(calculate("mod(1099511627776.0, 7)", symbolTable) == "2");
+    REQUIRE(calculate("mod(-7.0, 4)", symbolTable) == "-3");
+    REQUIRE(calculate("mod(-8.0, 4)", symbolTable) == "0");
+    REQUIRE(calculate("7.00005 % 4", symbolTable) == "3");
+    REQUIRE_THROWS_AS(calculate("mod(5, 0.00005)", symbolTable), std::invalid_argument);
+    REQUIRE(calculate("(-9223372036854775807 - 1) % -1", symbolTable) == "0");
+
+    /// Past 64 bits they are exact as well.
+    REQUIRE(calculate("9223372036854775807 + 1", symbolTable) == "9223372036854775808");
+    REQUIRE(calculate("-(-9223372036854775807 - 1)", symbolTable) == "9223372036854775808");
+    REQUIRE(calculate("99999999999999999999 * 99999999999999999999", symbolTable) == "9999999999999999999800000000000000000001");
+    REQUIRE(calculate("99999999999999999999 % 1000000007", symbolTable) == "4899");
+    REQUIRE(calculate("le(99999999999999999998, 99999999999999999999)", symbolTable) == "1");
+    REQUIRE(type("(9223372036854775807 + 1) - 1") == LITERAL_TYPE::INTEGER);
+
+    /// Division is exact when it leaves no remainder, and does not overflow otherwise.
+    symbolTable.add_definition("fact", {1, "if(#0, #0 * fact(#0 - 1), 1)"});
+    REQUIRE(calculate("fact(300) / fact(298)", symbolTable) == "89700");
+    REQUIRE(calculate("fact(300) / (fact(298) * 7)", symbolTable) == "12814.3");
+    REQUIRE(calculate("fact(298) / fact(300)", symbolTable) == "1.11483e-05");
+    REQUIRE(calculate("-7 / 2", symbolTable) == "-3.5");
+    REQUIRE(type("6 / 3") == LITERAL_TYPE::INTEGER);
+
+    /// Lists keep the integers a double would round.
+    REQUIRE(calculate("[12345678901234567890]", symbolTable) == "[12345678901234567890]");
+    REQUIRE(calculate("head([9007199254740993])", symbolTable) == "9007199254740993");
+    REQUIRE(calculate("nth([1, 9007199254740993], 1)", symbolTable) == "9007199254740993");
+    REQUIRE(calculate("[9007199254740992, 2]", symbolTable) == "[9.0072e+15 2]");
+    REQUIRE_THROWS_AS(calculate("[9007199254740993] + 1", symbolTable), std::invalid_argument);
+    REQUIRE(calculate("eq([9007199254740993], [9007199254740992])", symbolTable) == "0");
+    REQUIRE(calculate("eq([1180591620717411303424], 2 ^ 70)", symbolTable) == "1");
+    REQUIRE(calculate("unique([9007199254740993, 9007199254740992])", symbolTable) == "[9007199254740993 9.0072e+15]");
+}
+
+TEST_CASE("Expression number literals")
+{
+    SymbolTable symbolTable;
+
+    auto type = [&](const char* expression) {
+        return std::unique_ptr<Literal>(Expression(expression, symbolTable).calculate())->get_type();
+    };
+
+    REQUIRE(calculate("1.5e3", symbolTable) == "1500");
+    REQUIRE(calculate("25E-2", symbolTable) == "0.25");
+    REQUIRE(calculate("2.", symbolTable) == "2");
+    REQUIRE(calculate("0x1F", symbolTable) == "31");
+    REQUIRE(calculate("0x1.8p1", symbolTable) == "3");
+    REQUIRE(calculate("0xFFFFFFFFFFFFFFFFFF", symbolTable) == "4722366482869645213695");
+    REQUIRE(calculate("2 * E", symbolTable) == calculate("2*E", symbolTable));
+
+    REQUIRE(type("1e3") == LITERAL_TYPE::DOUBLE);
+    REQUIRE(type("0x10") == LITERAL_TYPE::INTEGER);
+
+    REQUIRE_THROWS_AS(calculate("1e999", symbolTable), std::invalid_argument);
+    REQUIRE_THROWS_AS(calculate("2e", symbolTable), std::invalid_argument);
+
+    /// The numbers of a list are not literals of their own.
+    std::size_t before = Literal::allocation_count();
+    REQUIRE(calculate("[1, 2.5e1, 0x10]", symbolTable) == "[1 25 16]");
+    REQUIRE(Literal::allocation_count() - before == 1);
+
+    REQUIRE(calculate("[1, [2e0], 0x3]", symbolTable) == "[1 [2] 3]");
+}
+
+TEST_CASE("Expression factorial")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("fact", {1, "if(#0, #0 * fact(#0 - 1), 1)"});
+
+    std::unique_ptr<Literal> result(Expression("fact(30)", symbolTable).calculate());
+    std::ostringstream os;
+    os << *result;
+
+    REQUIRE(os.str() == "265252859812191058636308480000000");
+}
+
 /// ------------------- Arithmetic expressions ---------------------
 TEST_CASE("Arithmetic expressions")
 {
@@ -574,4 +876,335 @@ TEST_CASE("Expression recursion")
     REQUIRE(*result == Double(25));
 
     delete result;
-}
\ No newline at end of file
+}
+/// --------------------- Symbol table overlay -----------------------
+TEST_CASE("Expression symbol table overlay")
+{
+    SymbolTable base;
+    base.add_definition("inc", std::make_pair(1, "#0 + 1"));
+
+    SymbolTable overlay(&base);
+    overlay.add_definition("twice", std::make_pair(1, "inc(inc(#0))"));
+
+    SymbolTable other(&base);
+    other.add_definition("inc", std::make_pair(1, "#0 + 10"));
+
+    Literal* result = Expression("twice(1)", overlay).calculate();
+    Literal* result1 = Expression("inc(1)", other).calculate();
+    Literal* result2 = Expression("inc(1)", base).calculate();
+
+    REQUIRE(*result == Double(3));
+    REQUIRE(*result1 == Double(11));
+    REQUIRE(*result2 == Double(2));
+    REQUIRE_FALSE(base.contains("twice"));
+    REQUIRE_THROWS_AS(Expression("twice(1)", other).calculate(), std::invalid_argument);
+
+    delete result;
+    delete result1;
+    delete result2;
+}
+
+/// --------------------- Evaluation budget -----------------------
+TEST_CASE("Expression evaluation budget")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("loop", std::make_pair(1, "loop(#0 + 1)"));
+    symbolTable.add_definition("len", std::make_pair(1, "if(#0,len(tail(#0)) + 1,0)"));
+
+    std::istringstream input;
+    std::ostringstream output;
+    EvaluationContext context(input, output);
+
+    context.set_budget({.max_steps = 1000});
+    context.begin_evaluation();
+    REQUIRE_THROWS_AS(Expression("loop(0)", symbolTable, nullptr, context).calculate(), budget_exceeded_exception);
+
+    context.set_budget({.max_depth = 100});
+    context.begin_evaluation();
+    REQUIRE_THROWS_AS(Expression("loop(0)", symbolTable, nullptr, context).calculate(), budget_exceeded_exception);
+
+    context.set_budget({.max_bytes = 1 << 16});
+    context.begin_evaluation();
+    REQUIRE_THROWS_AS(Expression("len(list(1,1,100000))", symbolTable, nullptr, context).calculate(), budget_exceeded_exception);
+
+    context.set_budget({.timeout = std::chrono::milliseconds(1)});
+    context.begin_evaluation();
+    REQUIRE_THROWS_AS(Expression("loop(0)", symbolTable, nullptr, context).calculate(), budget_exceeded_exception);
+
+    /// The budget is renewed by every evaluation.
+    context.set_budget({.max_steps = 100000, .max_depth = 100});
+    for (int k = 0; k < 3; ++k) {
+        context.begin_evaluation();
+        Literal* result = Expression("len(list(1,1,25))", symbolTable, nullptr, context).calculate();
+        REQUIRE(*result == Double(25));
+        delete result;
+    }
+}
+
+/// --------------------- Asynchronous evaluation -----------------------
+TEST_CASE("Expression asynchronous evaluation")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("tree", std::make_pair(1, "if(#0, tree(#0 - 1) + tree(#0 - 1), 1)"));
+    symbolTable.add_definition("len", std::make_pair(1, "if(#0,len(tail(#0)) + 1,0)"));
+
+    ThreadPool pool(1);
+
+    AsyncEvaluation finished = AsyncEvaluation::start("len(list(1,1,25)) + write(read())", symbolTable, &pool, {}, "42");
+    REQUIRE(finished.wait() == AsyncEvaluation::STATUS::FINISHED);
+    REQUIRE(*finished.get() == Double(25));
+    REQUIRE(finished.get_output() == "42\n");
+
+    AsyncEvaluation failed = AsyncEvaluation::start("len(5)", symbolTable, &pool);
+    REQUIRE(failed.wait() == AsyncEvaluation::STATUS::FAILED);
+    REQUIRE_THROWS_AS(failed.get(), std::invalid_argument);
+
+    /// Runs until cancelled, the budget only protects the test.
+    AsyncEvaluation endless = AsyncEvaluation::start("tree(60)", symbolTable, &pool, {.timeout = std::chrono::seconds(10)});
+    REQUIRE_FALSE(endless.wait_for(std::chrono::milliseconds(50)));
+    REQUIRE(endless.poll() == AsyncEvaluation::STATUS::RUNNING);
+
+    endless.cancel();
+    REQUIRE(endless.wait() == AsyncEvaluation::STATUS::CANCELLED);
+    REQUIRE_THROWS_AS(endless.get(), evaluation_cancelled_exception);
+
+    /// The pool's thread is free again.
+    AsyncEvaluation next = AsyncEvaluation::start("len([1,2,3])", symbolTable, &pool);
+    REQUIRE(*next.get() == Double(3));
+}
+
+/// --------------------- Suspending read -----------------------
+TEST_CASE("Expression suspending read")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("sum", std::make_pair(1, "if(#0, read() + sum(#0 - 1), 0)"));
+
+    std::istringstream input;
+    std::ostringstream output;
+    EvaluationContext context(input, output);
+    context.set_suspend_on_read(true);
+
+    Expression expr("sum(3) * 2", symbolTable, nullptr, context);
+    Task<std::unique_ptr<Literal>> task = expr.calculate_async();
+    task.resume();
+
+    for (int k = 1; k <= 3; ++k) {
+        REQUIRE_FALSE(task.done());
+        REQUIRE(context.is_waiting_for_input());
+        context.provide_input(k);
+    }
+
+    REQUIRE(task.done());
+    REQUIRE_FALSE(context.is_waiting_for_input());
+
+    std::unique_ptr<Literal> result = task.get();
+    REQUIRE(*result == Double(12));
+
+    REQUIRE_THROWS_AS(Expression("read()", symbolTable, nullptr, context).calculate(), std::logic_error);
+    REQUIRE_FALSE(context.is_waiting_for_input());
+}
+
+TEST_CASE("Expression profiling")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("sq", {1, "#0 * #0"});
+    symbolTable.add_definition("count", {1, "if(#0, count(#0 - 1) + sq(#0), 0)"});
+
+    Profiler profiler;
+    EvaluationContext context;
+    context.set_profiler(&profiler);
+
+    Expression expr("count(3)", symbolTable, nullptr, context);
+    Literal* result = expr.calculate();
+    REQUIRE(*result == Double(14));
+    delete result;
+
+    std::vector<Profiler::FunctionProfile> profiles = profiler.get_profiles();
+    REQUIRE(profiles.size() == 2);
+
+    for (const Profiler::FunctionProfile& profile : profiles) {
+        REQUIRE(profile.calls == (profile.name == "count" ? 4 : 3));
+        REQUIRE(profile.exclusive <= profile.inclusive);
+    }
+
+    std::ostringstream stacks;
+    profiler.write_collapsed_stacks(stacks);
+    REQUIRE(stacks.str().find("count;sq ") != std::string::npos);
+    REQUIRE(stacks.str().find("count;count") == std::string::npos);
+
+    /// A failing call does not break the profiling of the next ones.
+    Expression failing("count([1, [2]])", symbolTable, nullptr, context);
+    REQUIRE_THROWS_AS(failing.calculate(), std::invalid_argument);
+
+    Expression again("sq(2)", symbolTable, nullptr, context);
+    result = again.calculate();
+    delete result;
+
+    std::ostringstream table;
+    profiler.write_table(table);
+    REQUIRE(table.str().find("sq") != std::string::npos);
+}
+
+TEST_CASE("Expression tracing")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("sq", {1, "#0 * #0"});
+
+    Tracer tracer(4);
+    EvaluationContext context;
+    context.set_tracer(&tracer);
+
+    Expression expr("sq(3)", symbolTable, nullptr, context);
+    Literal* result = expr.calculate();
+    delete result;
+
+    std::vector<Tracer::Event> events = tracer.get_events();
+    REQUIRE(events.size() == 2);
+    REQUIRE(std::string(events[0].category) == "builtin");
+    REQUIRE(events[0].name == "*");
+    REQUIRE(events[0].arguments == "3, 3");
+    REQUIRE(std::string(events[1].category) == "user");
+    REQUIRE(events[1].name == "sq");
+    REQUIRE(events[1].start_ns <= events[0].start_ns);
+    REQUIRE(events[0].duration_ns <= events[1].duration_ns);
+
+    /// Only the latest events are kept.
+    Expression expr2("sq(1) + sq(2)", symbolTable, nullptr, context);
+    result = expr2.calculate();
+    delete result;
+
+    events = tracer.get_events();
+    REQUIRE(events.size() == 4);
+    REQUIRE(tracer.get_dropped() == 3);
+    REQUIRE(events.back().name == "+");
+    REQUIRE(events.front().name == "sq");
+
+    std::ostringstream os;
+    tracer.write_json(os);
+    REQUIRE(os.str().find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(os.str().find("\"ph\": \"X\"") != std::string::npos);
+
+    tracer.clear();
+    REQUIRE(tracer.get_events().empty());
+
+    /// if, nand and sortBy are traced, the argument separator is not.
+    Expression expr3("if(nand(1, 0), add(1, 2), 0)", symbolTable, nullptr, context);
+    result = expr3.calculate();
+    delete result;
+
+    events = tracer.get_events();
+    REQUIRE(events.size() == 3);
+    REQUIRE(events[0].name == "nand");
+    REQUIRE(events[1].name == "add");
+    REQUIRE(events[1].arguments == "1, 2");
+    REQUIRE(events[2].name == "if");
+    REQUIRE(std::string(events[2].category) == "builtin");
+
+    /// Long arguments are cut.
+    std::vector<std::unique_ptr<Literal>> arguments;
+    arguments.push_back(std::make_unique<List>(std::vector<double>(1000000, 1)));
+    arguments.push_back(std::make_unique<Double>(2));
+    std::string summary = Tracer::summarize(arguments);
+    REQUIRE(summary.size() == Tracer::MAX_SUMMARY_LENGTH);
+    REQUIRE(summary.starts_with("[1 1 1 1 1"));
+    REQUIRE(summary.ends_with("..."));
+    REQUIRE(Tracer::summarize({}).empty());
+}
+
+TEST_CASE("Expression metrics")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("sq", {1, "#0 * #0"});
+
+    auto builtin_calls = [](const Metrics::Snapshot& snapshot, const std::string& name) {
+        for (const auto&[builtin, calls] : snapshot.builtin_calls)
+            if (builtin == name)
+                return calls;
+        return (std::uint64_t) 0;
+    };
+
+    Metrics::Snapshot before = Metrics::snapshot();
+
+    Expression expr("sq(3) + sq(head(tail(concat([1], [2]))))", symbolTable);
+    Literal* result = expr.calculate();
+    delete result;
+
+    Metrics::Snapshot after = Metrics::snapshot();
+
+    REQUIRE(after.user_calls - before.user_calls == 2);
+    REQUIRE(builtin_calls(after, "*") - builtin_calls(before, "*") == 2);
+    REQUIRE(builtin_calls(after, "tail") - builtin_calls(before, "tail") == 1);
+    REQUIRE(builtin_calls(after, "+") - builtin_calls(before, "+") == 1);
+    REQUIRE(after.literals_allocated > before.literals_allocated);
+    REQUIRE(after.list_nodes_copied > before.list_nodes_copied);
+    REQUIRE(after.peak_depth >= 1);
+
+    std::stringstream input("1 + 1\n:stats\n");
+    std::ostringstream output;
+    EvaluationContext context(input, output);
+    FunctionParser parser(symbolTable, context);
+    input >> parser;
+    input >> parser;
+
+    after = Metrics::snapshot();
+    REQUIRE(after.evaluations - before.evaluations == 1);
+    REQUIRE(output.str().find("evaluations:") != std::string::npos);
+
+    std::ostringstream prometheus;
+    Metrics::write_prometheus(prometheus);
+    REQUIRE(prometheus.str().find("fli_builtin_calls_total{function=\"tail\"}") != std::string::npos);
+    REQUIRE(prometheus.str().find("fli_evaluation_duration_seconds_bucket{le=\"+Inf\"}") != std::string::npos);
+}
+
+TEST_CASE("Expression NDJSON output")
+{
+    SymbolTable symbolTable;
+
+    std::stringstream input("f -> add(#0, 1)\n\nf(1)\nwrite(list(1))\n[1, [2.5, 0x10]]\nfoo(1)\n");
+    std::ostringstream output;
+    EvaluationContext context(input, output);
+    context.set_output_format(OUTPUT_FORMAT::NDJSON);
+
+    FunctionParser parser(symbolTable, context);
+    while (input.peek() != EOF)
+        input >> parser;
+    context.flush_output();
+
+    std::string records = std::regex_replace(output.str(), std::regex("\"elapsed_us\":[0-9]+"), "\"elapsed_us\":0");
+    REQUIRE(records == "{\"id\":1,\"defined\":\"f\",\"redefined\":false}\n"
+                       "{\"id\":3,\"value\":2,\"elapsed_us\":0}\n"
+                       "{\"id\":4,\"write\":{\"infinite\":true,\"step\":1,\"first\":[1,2,3,4,5,6,7,8,9,10]}}\n"
+                       "{\"id\":4,\"value\":0,\"elapsed_us\":0}\n"
+                       "{\"id\":5,\"value\":[1,[2.5,16]],\"elapsed_us\":0}\n"
+                       "{\"id\":6,\"error\":\"Expression :: Unknown function or constant in expression: foo(1)\\ngiven: foo\","
+                       "\"elapsed_us\":0}\n");
+}
+
+TEST_CASE("Expression does not leak literals")
+{
+    SymbolTable symbolTable;
+    symbolTable.add_definition("sq", {1, "#0 * #0"});
+    symbolTable.add_definition("rev", {1, "if(eq(length(#0), 0), [], concat(rev(tail(#0)), [head(#0)]))"});
+
+    auto live = [] {
+        Metrics::Snapshot snapshot = Metrics::snapshot();
+        return snapshot.literals_allocated - snapshot.literals_freed;
+    };
+
+    std::uint64_t before = live();
+
+    for (const char* expression : {"sq(3) + 1",
+                                   "nand(1, 1)",
+                                   "nand(1, 0)",
+                                   "nand(0, 1)",
+                                   "if(1, [1, sq(2), [3]], 0)",
+                                   "rev([1, 2, 3, 4])",
+                                   "head(tail(list(1, 1)))"}) {
+        delete Expression(expression, symbolTable).calculate();
+    }
+
+    for (const char* expression : {"sq(1, 2)", "head([])", "1 +", "unknown(1)"})
+        REQUIRE_THROWS(Expression(expression, symbolTable).calculate());
+
+    REQUIRE(live() == before);
+}
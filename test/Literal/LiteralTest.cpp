@@ -2,6 +2,13 @@
 #include "catch.hpp"
 
 #include "Literal.h"
+#include "HashCons.h"
+#include "NumericKernels.h"
+#include "OutputBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
 #include <stdexcept>
 
 TEST_CASE("Test Double")
@@ -10,7 +17,7 @@ TEST_CASE("Test Double")
 
     REQUIRE(std::abs(d.get_double() - 3.14) < 0.001);
 
-    REQUIRE_THROWS_AS(d.get_list(), std::invalid_argument);
+    REQUIRE_THROWS_AS(d.get_numbers(), std::invalid_argument);
     REQUIRE_THROWS_AS(d.head(), std::invalid_argument);
     REQUIRE_THROWS_AS(d.tail(), std::invalid_argument);
     REQUIRE_THROWS_AS(d.length(), std::invalid_argument);
@@ -20,6 +27,43 @@ TEST_CASE("Test Double")
     REQUIRE(d.get_type() == LITERAL_TYPE::DOUBLE);
 }
 
+TEST_CASE("Test Integer")
+{
+    Integer i = BigInteger(9007199254740993);
+
+    REQUIRE(i.get_integer() == 9007199254740993);
+    REQUIRE(i.get_type() == LITERAL_TYPE::INTEGER);
+    REQUIRE(i.is_number());
+
+    REQUIRE_THROWS_AS(i.get_numbers(), std::invalid_argument);
+    REQUIRE_THROWS_AS(i.head(), std::invalid_argument);
+    REQUIRE_THROWS_AS(i.length(), std::invalid_argument);
+
+    /// Integers are compared exactly, and with the other numbers as doubles.
+    REQUIRE(i == Integer(9007199254740993));
+    REQUIRE(i != Integer(9007199254740992));
+    const Literal& three = Integer(3);
+    REQUIRE(three == Double(3.000001));
+    REQUIRE(Double(3) == three);
+    REQUIRE(three == List(3, 0, 1));
+    REQUIRE_FALSE(Integer(0));
+
+    std::ostringstream os;
+    os << i;
+    REQUIRE(os.str() == "9007199254740993");
+
+    /// The numbers of lists are doubles.
+    List numbers = Literal::list_type({new Integer(1), new Double(2)});
+    List mixed = Literal::list_type({new Integer(1), new List()});
+    REQUIRE(numbers.is_numeric());
+    REQUIRE(mixed.head()->get_type() == LITERAL_TYPE::DOUBLE);
+
+    /// Except the integers a double would round.
+    List big = Literal::list_type({new Integer(BigInteger(9007199254740993)), new Double(2)});
+    REQUIRE(!big.is_numeric());
+    REQUIRE(big.head()->get_type() == LITERAL_TYPE::INTEGER);
+}
+
 TEST_CASE("Double operator==")
 {
     const Literal& d = Double(3.14);
@@ -122,4 +166,441 @@ TEST_CASE("List intial_value ctor")
     REQUIRE_THROWS_AS(l1.to_double(), std::invalid_argument);
     REQUIRE(l1 == List(3.14, 1, 10));
     REQUIRE(LITERAL_TYPE::LIST == l1.get_type());
-}
\ No newline at end of file
+}
+TEST_CASE("List hash-consing")
+{
+    HashCons::set_enabled(true);
+
+    List l1 = List(std::vector<double>{1, 2, 3});
+    List l2 = List(1, 1, 3);
+    List nested1 = Literal::list_type({new Double(2), new List(l1)});
+    List nested2 = Literal::list_type({new List(2, 0, 1), new List(1, 1, 3)});
+
+    /// Equal lists share one node.
+    REQUIRE(l1.get_numbers().data() == l2.get_numbers().data());
+    REQUIRE(l1.tail().get_numbers().data() != l1.get_numbers().data());
+    REQUIRE(nested1.at(1)->get_numbers().data() == l1.get_numbers().data());
+    REQUIRE(nested1 == nested2);
+    REQUIRE(nested1.at(0) != nested2.at(0));
+
+    REQUIRE(l1 != List(1, 1, 4));
+    REQUIRE(List(1, 1) == List(1, 1));
+    REQUIRE(List(1, 1) != List(1, 2));
+    REQUIRE(HashCons::size() > 0);
+
+    /// Integers a double cannot hold are shared as well.
+    List big1 = Literal::list_type({new Integer(BigInteger(9007199254740993)), new List(l1)});
+    List big2 = Literal::list_type({new Integer(BigInteger(9007199254740993)), new List(l2)});
+    List big3 = Literal::list_type({new Integer(BigInteger(9007199254740995)), new List(l1)});
+    REQUIRE(big1 == big2);
+    REQUIRE(big1.at(0) == big2.at(0));
+    REQUIRE(big1 != big3);
+
+    HashCons::set_enabled(false);
+
+    List l3 = List(std::vector<double>{1, 2, 3});
+    REQUIRE(l3.get_numbers().data() != l1.get_numbers().data());
+    REQUIRE(l3 == l1);
+}
+
+TEST_CASE("List of numbers")
+{
+    List numbers(std::vector<double>{1, 2, 3});
+    List mixed = Literal::list_type({new Double(1), new List(2, 1, 2)});
+
+    REQUIRE(numbers.is_numeric());
+    REQUIRE_FALSE(mixed.is_numeric());
+    REQUIRE_THROWS_AS(mixed.get_numbers(), std::invalid_argument);
+
+    /// Lists which become lists of numbers are stored as numbers.
+    REQUIRE(mixed.tail().head()->get_numbers().size() == 2);
+    REQUIRE(List(std::vector<double>{0}).concat(numbers).is_numeric());
+    REQUIRE_FALSE(mixed.concat(numbers).is_numeric());
+
+    REQUIRE(mixed.concat(numbers).tail().tail() == numbers);
+    REQUIRE(*numbers.at(2) == Double(3));
+    REQUIRE(numbers.number_at(1) == 2);
+    REQUIRE_THROWS_AS(mixed.number_at(1), std::invalid_argument);
+
+    std::ostringstream os;
+    os << mixed.concat(List(4, 1));
+    REQUIRE(os.str() == "[1 [2 3] 4 5 6 7 8 9 10 11 12 13 ...]");
+    os.str("");
+    os << mixed.concat(List(4, 1)).tail().tail();
+    REQUIRE(os.str() == "[4 5 6 7 8 9 10 11 12 13 14 15 ...]");
+}
+
+TEST_CASE("List slices")
+{
+    List numbers(std::vector<double>{1, 2, 3, 4, 5});
+    List mixed = Literal::list_type({new Double(1), new List(2, 1, 2), new Double(4)});
+    List infinite(1, 2);
+
+    /// Slices of finite lists share the numbers of the list.
+    REQUIRE(numbers.slice(1, 4).get_numbers().data() == numbers.get_numbers().data() + 1);
+    REQUIRE(numbers.tail().get_numbers().data() == numbers.get_numbers().data() + 1);
+    REQUIRE(numbers.slice(1, 4) == List(std::vector<double>{2, 3, 4}));
+    REQUIRE(numbers.slice(3, 10) == List(std::vector<double>{4, 5}));
+    REQUIRE(numbers.slice(2, 2) == List());
+    REQUIRE_THROWS_AS(numbers.slice(3, 2), std::invalid_argument);
+
+    REQUIRE(numbers.take(2) == List(std::vector<double>{1, 2}));
+    REQUIRE(numbers.take(10) == numbers);
+    REQUIRE(numbers.drop(3) == List(std::vector<double>{4, 5}));
+    REQUIRE(numbers.drop(10) == List());
+    REQUIRE(numbers.reverse() == List(std::vector<double>{5, 4, 3, 2, 1}));
+
+    REQUIRE(*numbers.nth(4) == Double(5));
+    REQUIRE_THROWS_AS(numbers.nth(5), std::invalid_argument);
+    REQUIRE(*mixed.nth(1) == List(2, 1, 2));
+
+    /// Lists which become lists of numbers are stored as numbers.
+    REQUIRE_FALSE(mixed.take(2).is_numeric());
+    REQUIRE(mixed.drop(2).is_numeric());
+    REQUIRE(mixed.reverse().tail().tail() == List(std::vector<double>{1}));
+
+    /// Infinite lists generate the elements past the stored ones.
+    REQUIRE(*infinite.nth(100) == Double(201));
+    REQUIRE(infinite.take(3) == List(std::vector<double>{1, 3, 5}));
+    REQUIRE(infinite.slice(20, 22) == List(std::vector<double>{41, 43}));
+    REQUIRE(infinite.drop(20) == List(41, 2));
+    REQUIRE(infinite.drop(20).length() == -1);
+    REQUIRE_THROWS_AS(infinite.reverse(), std::invalid_argument);
+}
+
+TEST_CASE("List reuse")
+{
+    List numbers(std::vector<double>{3, 1, 2, 5, 4});
+    const double* data = numbers.get_numbers().data();
+
+    /// A list which is the only one referring to its numbers is modified in place.
+    REQUIRE(numbers.is_reusable());
+    REQUIRE(numbers.tail_in_place());
+    REQUIRE(numbers.sort_in_place());
+    REQUIRE(numbers.reverse_in_place());
+    REQUIRE(numbers.take_in_place(3));
+    REQUIRE(numbers == List(std::vector<double>{5, 4, 2}));
+    REQUIRE(numbers.get_numbers().data() == data + 1);
+    REQUIRE(numbers.length() == 3);
+
+    /// A list sharing its numbers is not.
+    auto copy = std::make_unique<List>(numbers);
+    List slice = copy->drop(1);
+    REQUIRE_FALSE(numbers.is_reusable());
+    REQUIRE_FALSE(slice.drop_in_place(1));
+    REQUIRE_FALSE(List(Literal::list_type({new Double(1), new List()})).is_reusable());
+    REQUIRE_FALSE(List().is_reusable());
+
+    /// Once the lists are gone, the slice is the only one referring to their numbers.
+    auto list = std::make_unique<List>(std::vector<double>{1, 2, 3});
+    List rest = list->tail();
+    list.reset();
+    REQUIRE(rest.drop_in_place(1));
+    REQUIRE(rest == List(std::vector<double>{3}));
+
+    List infinite(1, 2);
+    REQUIRE(infinite.tail_in_place());
+    REQUIRE(infinite == List(3, 2));
+    REQUIRE_FALSE(infinite.reverse_in_place());
+    REQUIRE_FALSE(infinite.take_in_place(2));
+
+    std::span<double> doubled = infinite.numbers_in_place(4);
+    for (double& number : doubled)
+        number *= 2;
+    REQUIRE(infinite == List(6, 4));
+}
+
+TEST_CASE("List concatenation")
+{
+    const int n = 100000;
+
+    /// Appending one element at a time.
+    auto appended = std::make_unique<List>();
+    for (int i = 0; i < n; ++i)
+        appended = std::make_unique<List>(appended->concat(List(std::vector<double>{(double) i})));
+
+    const List& built = *appended;
+
+    REQUIRE(built.size() == n);
+    REQUIRE(built.length() == n);
+    REQUIRE(built.is_numeric());
+    REQUIRE(*built.head() == Double(0));
+    REQUIRE(built.number_at(n - 1) == n - 1);
+    REQUIRE(built.number_at(54321) == 54321);
+
+    /// Walking it with tail().
+    auto rest = std::make_unique<List>(built);
+    for (int i = 0; i < 1000; ++i)
+        rest = std::make_unique<List>(rest->tail());
+    REQUIRE(rest->size() == n - 1000);
+    REQUIRE(*rest->head() == Double(1000));
+
+    REQUIRE(built.slice(99, 201) == List(99, 1, 102));
+    REQUIRE(built == List(0, 1, n));
+    REQUIRE(built.get_numbers().size() == n);
+    REQUIRE(built.get_numbers()[n - 1] == n - 1);
+
+    /// Prepending and mixing numbers and lists.
+    auto prepended = std::make_unique<List>();
+    for (int i = 0; i < 200; ++i) {
+        List element = i % 2 ? List(std::vector<double>{(double) i}) : List(Literal::list_type({new List(i, 1, 1)}));
+        prepended = std::make_unique<List>(element.concat(*prepended));
+    }
+
+    const List& mixed = *prepended;
+
+    REQUIRE(mixed.size() == 200);
+    REQUIRE_FALSE(mixed.is_numeric());
+    REQUIRE(*mixed.at(0) == Double(199));
+    REQUIRE(*mixed.at(199) == List(0, 1, 1));
+    REQUIRE(mixed.tail().tail().size() == 198);
+
+    /// Lists which become lists of numbers are stored as numbers.
+    REQUIRE(mixed.slice(0, 1).is_numeric());
+
+    std::ostringstream os;
+    os << mixed.take(4);
+    REQUIRE(os.str() == "[199 [198] 197 [196]]");
+
+    /// An infinite list appended to a finite one keeps its step.
+    os.str("");
+    os << built.take(2).concat(List(5, 2));
+    REQUIRE(os.str() == "[0 1 5 7 9 11 13 15 17 19 21 23 ...]");
+    REQUIRE_THROWS_AS(List(5, 2).concat(built), std::invalid_argument);
+}
+
+TEST_CASE("List sort, unique and search")
+{
+    List numbers(std::vector<double>{3, 1, 2, 3, 1});
+    List mixed = Literal::list_type({new Double(1), new List(2, 1, 2), new List(2, 1, 2), new Double(1)});
+
+    REQUIRE(numbers.sort() == List(std::vector<double>{1, 1, 2, 3, 3}));
+    REQUIRE(numbers.sort().unique() == List(std::vector<double>{1, 2, 3}));
+    REQUIRE(numbers.unique() == List(std::vector<double>{3, 1, 2}));
+    REQUIRE(mixed.unique().size() == 2);
+    REQUIRE_THROWS_AS(mixed.sort(), std::invalid_argument);
+    REQUIRE_THROWS_AS(List(1, 1).sort(), std::invalid_argument);
+
+    REQUIRE(numbers.index_of(Double(2)) == 2);
+    REQUIRE(numbers.index_of(Double(4)) == -1);
+    REQUIRE(mixed.index_of(List(2, 1, 2)) == 1);
+    REQUIRE(mixed.index_of(Double(2)) == -1);
+
+    REQUIRE(numbers.sort().binary_search(2) == 2);
+    REQUIRE(numbers.sort().binary_search(2.5) == -1);
+    REQUIRE(numbers.sort().binary_search(4) == -1);
+    REQUIRE(List().binary_search(1) == -1);
+}
+
+TEST_CASE("BigInteger")
+{
+    BigInteger max = std::numeric_limits<std::int64_t>::max();
+    BigInteger min = std::numeric_limits<std::int64_t>::min();
+
+    /// Values fitting in 64 bits are stored inline.
+    REQUIRE((max + 1).to_string() == "9223372036854775808");
+    REQUIRE_FALSE((max + 1).is_small());
+    REQUIRE((max + 1 - 1).is_small());
+    REQUIRE((-min).to_string() == "9223372036854775808");
+    REQUIRE((-(-min)).is_small());
+    REQUIRE(min - 1 < min);
+    REQUIRE(max * max > max);
+    REQUIRE((min * -1) / -1 == min);
+
+    BigInteger big = BigInteger::parse("-123456789012345678901234567890");
+    REQUIRE(big.to_string() == "-123456789012345678901234567890");
+    REQUIRE(BigInteger::parse("000123") == 123);
+    REQUIRE(std::abs(big.to_double() + 1.2345678901234568e29) < 1e15);
+    REQUIRE_THROWS_AS(BigInteger::parse("12a"), std::invalid_argument);
+    REQUIRE(BigInteger::parse("ff", 16) == 255);
+    REQUIRE(BigInteger::parse("-1000000000000000000", 16).to_string() == "-4722366482869645213696");
+
+    /// Division truncates towards zero.
+    BigInteger divisor = BigInteger::parse("98765432109876543210");
+    REQUIRE(big / divisor == -1249999988);
+    REQUIRE(big % divisor == big + divisor * 1249999988);
+    REQUIRE(BigInteger(-7) % 2 == -1);
+    REQUIRE_THROWS_AS(big / 0, std::invalid_argument);
+
+    /// Ratios of operands too large for doubles.
+    REQUIRE(BigInteger::ratio(7, 2) == 3.5);
+    REQUIRE(BigInteger::ratio(big, big * -4) == -0.25);
+    REQUIRE(std::abs(BigInteger::ratio(big * big + 1, big) / big.to_double() - 1) < 1e-15);
+    REQUIRE(std::isinf(BigInteger::ratio(1, 0)));
+
+    REQUIRE(BigInteger::from_double(-0x1p70).to_string() == "-1180591620717411303424");
+    REQUIRE(BigInteger::from_double(1e19 + 2048) == BigInteger::parse("10000000000000002048"));
+    REQUIRE(BigInteger::from_double(-7) == -7);
+    REQUIRE_THROWS_AS(BigInteger::from_double(0.5), std::invalid_argument);
+
+    /// 3^2000 has 100 limbs, its products are Karatsuba multiplications.
+    BigInteger power = 1;
+    for (int i = 0; i < 2000; ++i)
+        power = power * 3;
+    REQUIRE(power.size() >= 3 * BigInteger::KARATSUBA_THRESHOLD);
+
+    BigInteger square = power * power;
+    BigInteger product = (power + 1) * (power - 1);
+    REQUIRE(product == square - 1);
+    REQUIRE(square / power == power);
+    REQUIRE(square % power == 0);
+    REQUIRE((square + 5) % power == 5);
+    REQUIRE((power * big) / big == power);
+    REQUIRE(square.to_string().size() == 1909);
+}
+
+TEST_CASE("OutputBuffer")
+{
+    std::ostringstream os;
+
+    {
+        OutputBuffer buffer(os, 128);
+        buffer << 1.0 / 3 << ' ' << BigInteger::parse("-123456789012345678901234567890") << ' ' << Integer(42);
+        REQUIRE(os.str().empty());
+        REQUIRE(buffer.pending() == 43);
+
+        buffer.flush();
+        REQUIRE(os.str() == "0.333333 -123456789012345678901234567890 42");
+
+        /// Written when the buffer is full.
+        os.str("");
+        for (int i = 0; i < 10; ++i)
+            buffer << List(std::vector<double>{1, 2.5, 1e-5});
+        REQUIRE(!os.str().empty());
+        REQUIRE(buffer.pending() < 128);
+        REQUIRE(os.str().size() + buffer.pending() == 10 * 13);
+
+        buffer.flush();
+        os.str("");
+        buffer.set_precision(OutputBuffer::SHORTEST);
+        buffer << 0.1 + 0.2 << ' ' << 1e300 << ' ' << -0.0;
+        buffer.set_precision(OutputBuffer::MAX_PRECISION);
+        buffer << ' ' << 0.1;
+
+        REQUIRE_THROWS_AS(buffer.set_precision(OutputBuffer::MAX_PRECISION + 1), std::invalid_argument);
+        REQUIRE_THROWS_AS(buffer.set_precision(-1), std::invalid_argument);
+    }
+    REQUIRE(os.str() == "0.30000000000000004 1e+300 -0 0.10000000000000001");
+
+    os.str("");
+    {
+        OutputBuffer buffer(os);
+        List mixed(Literal::elements_type{std::make_shared<const Double>(-2.5),
+                                          std::make_shared<const List>(std::vector<double>{0.1, 1.0 / 0.0}),
+                                          std::make_shared<const List>()});
+        buffer.write_json(mixed);
+        buffer << ' ';
+        buffer.write_json(List(1, 1));
+        buffer << ' ';
+        buffer.write_json(Integer(BigInteger::parse("123456789012345678901")));
+        buffer << ' ';
+        buffer.write_json("a\"b\\c\n\x01");
+    }
+    REQUIRE(os.str() == "[-2.5,[0.1,null],[]] {\"infinite\":true,\"step\":1,\"first\":[1,2,3,4,5,6,7,8,9,10]} 123456789012345678901 \"a\\\"b\\\\c\\n\\u0001\"");
+
+    /// Nested deeper than recursive printing or freeing could go.
+    constexpr int DEPTH = 200000;
+    Literal::element_type nested = std::make_shared<const List>(std::vector<double>{1});
+    for (int i = 1; i < DEPTH; ++i)
+        nested = std::make_shared<const List>(Literal::elements_type{nested, std::make_shared<const Double>(i)});
+
+    os.str("");
+    os << *nested;
+    std::string printed = os.str();
+    REQUIRE(printed.starts_with(std::string(DEPTH, '[') + "1] 1] 2]"));
+    REQUIRE(printed.ends_with(" 199998] 199999]"));
+
+    /// Nested through slices and concatenations, freed without recursing either.
+    {
+        List numbers(std::vector<double>(100, 1));
+        Literal::element_type sliced = std::make_shared<const List>(std::vector<double>{1});
+        Literal::element_type joined = sliced;
+        for (int i = 1; i < DEPTH; ++i) {
+            sliced = std::make_shared<const List>(List(Literal::elements_type{std::make_shared<const Double>(i), sliced}).tail());
+            joined = std::make_shared<const List>(List(Literal::elements_type{joined}).concat(numbers));
+        }
+        REQUIRE(sliced->length() == 1);
+        REQUIRE(joined->length() == 101);
+        sliced.reset();
+        joined.reset();
+    }
+
+    /// Only the beginning, up to the number reaching the length.
+    os.str("");
+    {
+        OutputBuffer buffer(os, 64);
+        buffer.write(List(std::vector<double>(1000000, 1)), 6);
+        buffer << ' ';
+        buffer.write(*nested, 3 * DEPTH);
+        REQUIRE(buffer.size() < 4 * DEPTH);
+    }
+    REQUIRE(os.str().starts_with("[1 1 1 " + std::string(DEPTH, '[') + "1] 1]"));
+}
+
+TEST_CASE("NumericKernels")
+{
+    using Operation = NumericKernels::Operation;
+
+    /// Sizes around the vector width.
+    for (std::size_t n = 0; n <= 9; ++n) {
+        std::vector<double> a(n), b(n), out(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            a[i] = (double) i + 1;
+            b[i] = 2.0 * (double) (n - i);
+        }
+
+        NumericKernels::apply(Operation::ADD, a, b, out);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == a[i] + b[i]);
+
+        NumericKernels::apply(Operation::SUB, a, 1.5, out);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == a[i] - 1.5);
+
+        NumericKernels::apply(Operation::DIV, 1.0, a, out);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == 1.0 / a[i]);
+
+        NumericKernels::apply(Operation::LESS, a, b, out);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == (a[i] < b[i] ? 1.0 : 0.0));
+
+        /// In place.
+        NumericKernels::apply(Operation::MUL, a, a, a);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(a[i] == (double) ((i + 1) * (i + 1)));
+
+        NumericKernels::sqrt(a, out);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == (double) (i + 1));
+
+        NumericKernels::apply(Operation::DIV, out, 2.0, out);
+        NumericKernels::floor(out, out);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == (double) ((i + 1) / 2));
+
+        REQUIRE(NumericKernels::sum(b) == (double) (n * (n + 1)));
+
+        REQUIRE(NumericKernels::equal(a, a, 0.00001));
+        if (n) {
+            std::vector<double> c = a;
+            c[n - 1] += 0.000001;
+            REQUIRE(NumericKernels::equal(a, c, 0.00001));
+            c[n - 1] += 0.1;
+            REQUIRE_FALSE(NumericKernels::equal(a, c, 0.00001));
+            c[n - 1] = std::nan("");
+            REQUIRE_FALSE(NumericKernels::equal(a, c, 0.00001));
+        }
+    }
+
+    /// Large enough to be sorted by several threads, with NaNs last.
+    std::vector<double> numbers(3 * NumericKernels::PARALLEL_SORT_SIZE + 5);
+    for (std::size_t i = 0; i < numbers.size(); ++i)
+        numbers[i] = (double) ((i * 7919) % 1000);
+    numbers[10] = std::nan("");
+
+    NumericKernels::sort(numbers);
+    REQUIRE(std::is_sorted(numbers.begin(), numbers.end() - 1));
+    REQUIRE(std::isnan(numbers.back()));
+    REQUIRE(numbers.front() == 0);
+}
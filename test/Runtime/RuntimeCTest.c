@@ -0,0 +1,151 @@
+#include "fli.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(condition)                                                     \
+    do {                                                                     \
+        ++checks;                                                            \
+        if (!(condition)) {                                                  \
+            ++failures;                                                      \
+            fprintf(stderr, "%s:%d: FAILED: %s\n", __FILE__, __LINE__, #condition); \
+        }                                                                    \
+    } while (0)
+
+static void test_define(fli_runtime* runtime)
+{
+    CHECK(fli_define(runtime, "sq", "#0 * #0") == FLI_OK);
+    CHECK(fli_define(runtime, "sum", "if(length(#0), head(#0) + sum(tail(#0)), 0)") == FLI_OK);
+
+    CHECK(fli_define(runtime, "add", "#0") == FLI_ERROR_INVALID_ARGUMENT);
+    CHECK(strlen(fli_last_error()) > 0);
+
+    CHECK(fli_define(runtime, "f", "add(#0, 1") == FLI_ERROR_INVALID_ARGUMENT);
+    CHECK(fli_define(NULL, "f", "#0") == FLI_ERROR_INVALID_ARGUMENT);
+}
+
+static void test_call(fli_runtime* runtime)
+{
+    fli_function* function = NULL;
+    fli_value* value = NULL;
+    double number = 0;
+    double numbers[] = {1, 2, 3};
+    fli_argument arguments[2];
+
+    CHECK(fli_compile(runtime, "sq(#0) + sum(#1)", &function) == FLI_OK);
+    CHECK(fli_function_arity(function) == 2);
+
+    arguments[0] = fli_number(2);
+    arguments[1] = fli_list(numbers, 3);
+    CHECK(fli_call(runtime, function, arguments, 2, &value) == FLI_OK);
+    CHECK(fli_value_number(value, &number) == FLI_OK && number == 10);
+    CHECK(!fli_value_is_list(value));
+    fli_value_free(value);
+
+    CHECK(fli_call(runtime, function, arguments, 1, &value) == FLI_ERROR_INVALID_ARGUMENT);
+    CHECK(value == NULL);
+
+    fli_function_free(function);
+
+    CHECK(fli_compile(runtime, "unknown(#0)", &function) == FLI_ERROR_INVALID_ARGUMENT);
+}
+
+static void test_batch(fli_runtime* runtime)
+{
+    fli_function* function = NULL;
+    fli_value* results[4];
+    fli_argument arguments[4];
+    double numbers[] = {0, 1, 2, 3};
+    double number = 0;
+    size_t i;
+
+    CHECK(fli_compile(runtime, "sq(head(#0))", &function) == FLI_OK);
+
+    for (i = 0; i < 4; ++i)
+        arguments[i] = fli_list(&numbers[i], 1);
+
+    CHECK(fli_call_batch(runtime, function, arguments, 4, results) == FLI_OK);
+    for (i = 0; i < 4; ++i) {
+        CHECK(fli_value_number(results[i], &number) == FLI_OK && number == (double) (i * i));
+        fli_value_free(results[i]);
+    }
+
+    /// An empty list fails the second call.
+    arguments[1] = fli_list(NULL, 0);
+    CHECK(fli_call_batch(runtime, function, arguments, 4, results) == FLI_ERROR_INVALID_ARGUMENT);
+    CHECK(results[0] != NULL && results[1] == NULL && results[3] == NULL);
+    fli_value_free(results[0]);
+
+    fli_function_free(function);
+}
+
+static void test_values(fli_runtime* runtime)
+{
+    fli_value* value = NULL;
+    fli_value* element = NULL;
+    double numbers[2];
+    double number = 0;
+    size_t size = 0;
+    int64_t length = 0;
+    char buffer[4];
+
+    CHECK(fli_evaluate(runtime, "list(1, 1, 3)", &value) == FLI_OK);
+    CHECK(fli_value_is_list(value));
+    CHECK(fli_value_size(value, &length) == FLI_OK && length == 3);
+
+    CHECK(fli_value_numbers(value, numbers, 2, &size) == FLI_OK && size == 3);
+    CHECK(numbers[0] == 1 && numbers[1] == 2);
+
+    CHECK(fli_value_at(value, 2, &element) == FLI_OK);
+    CHECK(fli_value_number(element, &number) == FLI_OK && number == 3);
+    fli_value_free(element);
+
+    CHECK(fli_value_at(value, 3, &element) == FLI_ERROR_OUT_OF_RANGE);
+    CHECK(fli_value_number(value, &number) == FLI_ERROR_INVALID_ARGUMENT);
+
+    CHECK(fli_value_to_string(value, buffer, sizeof(buffer), &size) == FLI_OK);
+    CHECK(size == 7 && strcmp(buffer, "[1 ") == 0);
+    fli_value_free(value);
+
+    CHECK(fli_evaluate(runtime, "sqrt(2)", &value) == FLI_OK);
+    CHECK(fli_value_number(value, &number) == FLI_OK && fabs(number - sqrt(2)) < 1e-12);
+    fli_value_free(value);
+}
+
+static void test_budget(fli_runtime* runtime)
+{
+    fli_value* value = NULL;
+
+    CHECK(fli_define(runtime, "loop", "loop(#0)") == FLI_OK);
+    CHECK(fli_set_budget(runtime, 0, 0, 0, 100) == FLI_OK);
+    CHECK(fli_evaluate(runtime, "loop(1)", &value) == FLI_ERROR_BUDGET_EXCEEDED);
+    CHECK(value == NULL);
+    CHECK(fli_set_budget(runtime, 0, 0, 0, 0) == FLI_OK);
+}
+
+int main(void)
+{
+    fli_runtime* runtime = NULL;
+
+    CHECK(fli_runtime_create(&runtime) == FLI_OK);
+
+    test_define(runtime);
+    test_call(runtime);
+    test_batch(runtime);
+    test_values(runtime);
+    test_budget(runtime);
+
+    fli_runtime_free(runtime);
+
+    if (failures) {
+        fprintf(stderr, "%d of %d checks failed\n", failures, checks);
+        return 1;
+    }
+
+    printf("All tests passed (%d checks)\n", checks);
+    return 0;
+}
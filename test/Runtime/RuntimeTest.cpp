@@ -0,0 +1,95 @@
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+
+#include "Runtime.h"
+#include "budget_exceeded_exception.h"
+
+#include <sstream>
+
+TEST_CASE("Runtime define")
+{
+    Runtime runtime;
+
+    REQUIRE_FALSE(runtime.define("sq", "#0 * #0"));
+    REQUIRE(runtime.define("sq", "mul(#0, #0)"));
+
+    REQUIRE_THROWS_AS(runtime.define("add", "#0"), std::invalid_argument);
+    REQUIRE_THROWS_AS(runtime.define("f-1", "#0"), std::invalid_argument);
+    REQUIRE_THROWS_AS(runtime.define("f", "add(#0, 1"), std::invalid_argument);
+
+    REQUIRE(runtime.evaluate("sq(3)").as_number() == 9);
+}
+
+TEST_CASE("Runtime compile and call")
+{
+    Runtime runtime;
+    runtime.define("sq", "#0 * #0");
+    runtime.define("sum", "if(length(#0), head(#0) + sum(tail(#0)), 0)");
+
+    Runtime::Function sq = runtime.compile("sq(#0)");
+    Runtime::Function expr = runtime.compile("sq(#0) + sum(#1)");
+
+    REQUIRE(sq.get_arity() == 1);
+    REQUIRE(expr.get_arity() == 2);
+
+    REQUIRE(runtime.call(sq, 4.0).as_number() == 16);
+
+    std::vector<double> numbers{1, 2, 3};
+    REQUIRE(runtime.call(expr, 2.0, numbers).as_number() == 10);
+
+    REQUIRE_THROWS_AS(runtime.call(sq), std::invalid_argument);
+    REQUIRE_THROWS_AS(runtime.call(sq, 1.0, 2.0), std::invalid_argument);
+
+    REQUIRE_THROWS_AS(runtime.compile("unknown(#0)"), std::invalid_argument);
+    REQUIRE_THROWS_AS(runtime.compile("sq(#0"), std::invalid_argument);
+
+    /// Handles call the current definition.
+    runtime.define("sq", "#0 * #0 * #0");
+    REQUIRE(runtime.call(sq, 2.0).as_number() == 8);
+
+    runtime.define("sq", "#0 * #1");
+    REQUIRE_THROWS_AS(runtime.call(sq, 2.0), std::invalid_argument);
+}
+
+TEST_CASE("Runtime values")
+{
+    Runtime runtime;
+
+    Runtime::Value list = runtime.evaluate("list(1, 1, 3)");
+    REQUIRE(list.is_list());
+    REQUIRE(list.size() == 3);
+    REQUIRE(list.as_numbers() == std::vector<double>{1, 2, 3});
+    REQUIRE(list[1].as_number() == 2);
+    REQUIRE_THROWS_AS(list[3], std::out_of_range);
+    REQUIRE_THROWS_AS(list.as_number(), std::invalid_argument);
+    REQUIRE(list.to_string() == "[1 2 3]");
+
+    Runtime::Value infinite = runtime.evaluate("list(1, 2)");
+    REQUIRE(infinite.size() == -1);
+    REQUIRE(infinite[100].as_number() == 201);
+    REQUIRE_THROWS_AS(infinite.as_numbers(), std::invalid_argument);
+
+    Runtime::Value nested = runtime.evaluate("[[1, 2], 3]");
+    REQUIRE(nested[0].as_numbers() == std::vector<double>{1, 2});
+    REQUIRE_THROWS_AS(nested.as_numbers(), std::invalid_argument);
+
+    Runtime::Value number = runtime.evaluate("sqrt(16)");
+    REQUIRE(number.is_number());
+    REQUIRE(number.as_number() == 4);
+    REQUIRE_THROWS_AS(number.size(), std::invalid_argument);
+}
+
+TEST_CASE("Runtime output and budget")
+{
+    Runtime runtime;
+    std::ostringstream output;
+    runtime.set_output(output);
+
+    runtime.evaluate("write(5)");
+    REQUIRE(output.str() == "5\n");
+
+    runtime.define("loop", "loop(#0)");
+    runtime.set_budget(EvaluationBudget{.max_depth = 100});
+    REQUIRE_THROWS_AS(runtime.evaluate("loop(1)"), budget_exceeded_exception);
+}